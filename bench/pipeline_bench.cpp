@@ -0,0 +1,545 @@
+#include "interfaces.h"
+#include "Common/ReferenceModelCache.h"
+#include "Cropping/StubCropper.h"
+#include "FeatureDetection/BriskDetector.h"
+#include "FeatureDetection/MultiRefDetector.h"
+#include "FeatureDetection/ORBDetector.h"
+#include "FeatureDetection/TiledOrbExtractor.h"
+#include "FeatureDetection/TrackingDetector.h"
+#include "Geometry/RobustEstimator.h"
+#include "Matching/HammingMatcher.h"
+#include "Matching/LshIndex.h"
+#include "Stabilization/EdRansacStabilizer.h"
+#include "Stabilization/OFStabilizer.h"
+#include "Stabilization/PhaseCorrStabilizer.h"
+#include "Stabilization/TelemetryStabilizer.h"
+#include "VideoOutputStream/GstreamerFileOutput.h"
+
+#include <gst/gst.h>
+#include <opencv2/calib3d.hpp>
+#include <opencv2/features2d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <functional>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// pipeline_bench
+//
+// Repeatable micro-benchmarks of each pipeline component on synthetic
+// 4056x3040 frames (I420, as delivered by the capture stage).
+//
+// Usage:
+//   ./pipeline_bench [iterations] [name-filter]
+//
+// For every benchmark it reports frames/sec, ms and ns per source pixel per
+// call, and heap allocations per call — both operator new and cv::Mat
+// buffer allocations (OpenCV allocates Mats with its own allocator, which
+// operator new never sees).
+//
+// Frames come from a fixed-seed RNG, so runs are comparable across builds
+// and machines; detector references are patches cut from the same scene.
+// ─────────────────────────────────────────────────────────────────────────────
+
+// ── Allocation counting ──────────────────────────────────────────────────────
+
+namespace {
+
+std::atomic<std::uint64_t> g_new_calls{ 0 };
+std::atomic<std::uint64_t> g_mat_allocs{ 0 };
+
+// Counts buffer allocations, delegating the work to OpenCV's std allocator.
+class CountingMatAllocator : public cv::MatAllocator {
+public:
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                           size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage) const override
+    {
+        g_mat_allocs.fetch_add(1, std::memory_order_relaxed);
+        return std_->allocate(dims, sizes, type, data, step, flags, usage);
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags,
+                  cv::UMatUsageFlags usage) const override
+    {
+        return std_->allocate(u, flags, usage);
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+        std_->deallocate(u);
+    }
+
+private:
+    cv::MatAllocator* std_ = cv::Mat::getStdAllocator();
+};
+
+} // namespace
+
+void* operator new(std::size_t size)
+{
+    g_new_calls.fetch_add(1, std::memory_order_relaxed);
+    if (void* p = std::malloc(size ? size : 1)) return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+// ── Synthetic input ──────────────────────────────────────────────────────────
+
+constexpr int kSrcWidth   = 4056;
+constexpr int kSrcHeight  = 3040;
+constexpr int kOutWidth   = 1920;
+constexpr int kOutHeight  = 1080;
+constexpr int kSeqLength  = 8;          // distinct frames, cycled
+constexpr int kWarmup     = 3;
+
+struct Scene {
+    std::vector<cv::Mat> frames_i420;   // packed I420, jittered camera motion
+    std::vector<cv::Mat> references;    // BGR patches of the scene, [0] is the main one
+};
+
+// Blobby texture plus sharp shapes — gives ORB/BRISK/LK realistic corners.
+Scene make_scene()
+{
+    cv::RNG rng(0xA5A5A5);
+
+    cv::Mat noise(kSrcHeight / 8, kSrcWidth / 8, CV_8UC3);
+    rng.fill(noise, cv::RNG::UNIFORM, 0, 256);
+
+    cv::Mat base;
+    cv::resize(noise, base, cv::Size(kSrcWidth, kSrcHeight), 0, 0, cv::INTER_CUBIC);
+
+    for (int i = 0; i < 400; ++i) {
+        const cv::Point  p(rng.uniform(0, kSrcWidth), rng.uniform(0, kSrcHeight));
+        const cv::Scalar c(rng.uniform(0, 255), rng.uniform(0, 255), rng.uniform(0, 255));
+        if (i % 2 == 0) {
+            cv::rectangle(base, p, p + cv::Point(rng.uniform(10, 120), rng.uniform(10, 120)),
+                          c, cv::FILLED);
+        } else {
+            cv::circle(base, p, rng.uniform(5, 60), c, cv::FILLED);
+        }
+    }
+
+    Scene scene;
+    for (const cv::Rect& r : { cv::Rect(1800, 1300, 480, 360), cv::Rect(400, 500, 480, 360),
+                               cv::Rect(3000, 600, 480, 360),  cv::Rect(900, 2300, 480, 360) }) {
+        scene.references.push_back(base(r).clone());
+    }
+
+    // Small rotation + translation per frame, like platform jitter.
+    const cv::Point2f centre(kSrcWidth / 2.f, kSrcHeight / 2.f);
+    for (int i = 0; i < kSeqLength; ++i) {
+        cv::Mat M = cv::getRotationMatrix2D(centre, rng.uniform(-0.5, 0.5), 1.0);
+        M.at<double>(0, 2) += rng.uniform(-12.0, 12.0);
+        M.at<double>(1, 2) += rng.uniform(-12.0, 12.0);
+
+        cv::Mat bgr, i420;
+        cv::warpAffine(base, bgr, M, base.size(), cv::INTER_LINEAR, cv::BORDER_REFLECT);
+        cv::cvtColor(bgr, i420, cv::COLOR_BGR2YUV_I420);
+        scene.frames_i420.push_back(i420);
+    }
+    return scene;
+}
+
+RawFrame make_raw(const Scene& scene, int i)
+{
+    RawFrame frame;
+    frame.data   = scene.frames_i420[i % kSeqLength];
+    frame.format = PixelFormat::I420;
+    frame.pts_ns = static_cast<std::int64_t>(i) * 33'333'333;
+    return frame;
+}
+
+// ── Harness ──────────────────────────────────────────────────────────────────
+
+struct Result {
+    std::string   name;
+    int           iterations = 0;
+    double        seconds    = 0.0;
+    double        pixels     = 0.0;     // pixels processed per call
+    std::uint64_t new_calls  = 0;
+    std::uint64_t mat_allocs = 0;
+};
+
+std::vector<Result> g_results;
+
+void run_bench(const std::string&              name,
+               const std::string&              filter,
+               int                             iterations,
+               double                          pixels_per_call,
+               const std::function<void(int)>& fn)
+{
+    if (!filter.empty() && name.find(filter) == std::string::npos) return;
+
+    std::cout << "  running " << name << " ..." << std::flush;
+
+    for (int i = 0; i < kWarmup; ++i) fn(i);
+
+    const std::uint64_t new0 = g_new_calls.load();
+    const std::uint64_t mat0 = g_mat_allocs.load();
+    const auto t0 = std::chrono::steady_clock::now();
+
+    for (int i = 0; i < iterations; ++i) fn(kWarmup + i);
+
+    const auto t1 = std::chrono::steady_clock::now();
+
+    Result r;
+    r.name       = name;
+    r.iterations = iterations;
+    r.seconds    = std::chrono::duration<double>(t1 - t0).count();
+    r.pixels     = pixels_per_call;
+    r.new_calls  = g_new_calls.load() - new0;
+    r.mat_allocs = g_mat_allocs.load() - mat0;
+    g_results.push_back(r);
+
+    std::cout << " done\n";
+}
+
+void print_results()
+{
+    std::cout << "\n"
+              << std::left  << std::setw(40) << "benchmark"
+              << std::right << std::setw(10) << "fps"
+              << std::setw(11) << "ms/call"
+              << std::setw(11) << "ns/pixel"
+              << std::setw(12) << "new/call"
+              << std::setw(12) << "Mat/call" << "\n"
+              << std::string(96, '-') << "\n"
+              << std::fixed;
+
+    for (const Result& r : g_results) {
+        const double per_call = r.seconds / r.iterations;
+        std::cout << std::left  << std::setw(40) << r.name << std::right
+                  << std::setprecision(1) << std::setw(10) << 1.0 / per_call
+                  << std::setprecision(2) << std::setw(11) << per_call * 1e3
+                  << std::setprecision(3) << std::setw(11) << per_call * 1e9 / r.pixels
+                  << std::setprecision(1)
+                  << std::setw(12) << static_cast<double>(r.new_calls)  / r.iterations
+                  << std::setw(12) << static_cast<double>(r.mat_allocs) / r.iterations
+                  << "\n";
+    }
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// main
+// ─────────────────────────────────────────────────────────────────────────────
+
+int main(int argc, char* argv[])
+{
+    gst_init(&argc, &argv);
+
+    const int         iterations = (argc > 1) ? std::max(1, std::atoi(argv[1])) : 30;
+    const std::string filter     = (argc > 2) ? argv[2] : "";
+
+    static CountingMatAllocator counting_allocator;
+    cv::Mat::setDefaultAllocator(&counting_allocator);
+
+    std::cout << "[pipeline_bench] Generating " << kSeqLength << " synthetic "
+              << kSrcWidth << "x" << kSrcHeight << " frames...\n";
+    const Scene scene = make_scene();
+
+    const auto tmp_dir   = std::filesystem::temp_directory_path();
+    std::vector<std::string> reference_paths;
+    for (std::size_t i = 0; i < scene.references.size(); ++i) {
+        reference_paths.push_back(
+            (tmp_dir / ("pipeline_bench_reference" + std::to_string(i) + ".png")).string());
+        cv::imwrite(reference_paths.back(), scene.references[i]);
+    }
+    const std::string& reference_path = reference_paths.front();
+    const std::string output_path    = (tmp_dir / "pipeline_bench_output.mp4").string();
+
+    const double src_pixels = static_cast<double>(kSrcWidth) * kSrcHeight;
+    const double out_pixels = static_cast<double>(kOutWidth) * kOutHeight;
+    const DetectionResult centre_detection{
+        { kSrcWidth / 2.f, kSrcHeight / 2.f }, 1.f, true };
+
+    std::cout << "[pipeline_bench] " << iterations << " iterations per benchmark ("
+              << kWarmup << " warm-up)\n";
+
+    // ── Detectors ────────────────────────────────────────────────────────────
+    {
+        ORBDetector orb;
+        if (orb.init("", "", reference_path)) {
+            orb.useSearchWindow = false;
+            run_bench("ORBDetector::detect (full frame)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); orb.detect(f); });
+
+            orb.coarseScale = 0.25f;
+            run_bench("ORBDetector::detect (coarse 0.25 + refine)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); orb.detect(f); });
+            orb.coarseScale = 1.f;
+
+            orb.useSearchWindow   = true;
+            orb.useGuidedMatching = false;
+            run_bench("ORBDetector::detect (search window)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); orb.detect(f); });
+
+            orb.useGuidedMatching = true;
+            run_bench("ORBDetector::detect (search window, guided)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); orb.detect(f); });
+        }
+    }
+    {
+        TrackingDetector tracker(std::make_unique<ORBDetector>());
+        tracker.detect_every_n = 5;
+        if (tracker.init("", "", reference_path)) {
+            run_bench("TrackingDetector::detect (ORB every 5)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); tracker.detect(f); });
+        }
+    }
+    {
+        BriskDetector brisk;
+        if (brisk.init("", "", reference_path)) {
+            run_bench("BriskDetector::detect", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); brisk.detect(f); });
+        }
+    }
+
+    {
+        MultiRefDetector multi;
+        std::string spec;
+        for (const std::string& path : reference_paths) spec += path + ";";
+        if (multi.init("", "", spec)) {
+            run_bench("MultiRefDetector::detect_all (" + std::to_string(reference_paths.size()) +
+                          " refs)", filter, iterations, src_pixels,
+                      [&](int i) { RawFrame f = make_raw(scene, i); multi.detect_all(f); });
+        }
+    }
+
+    // ── ORB extraction: single call vs. tile-parallel ───────────────────────
+    {
+        cv::Ptr<cv::ORB>  orb = cv::ORB::create(2000);
+        TiledOrbExtractor extractor;
+        std::vector<cv::KeyPoint> kps;
+        cv::Mat desc;
+
+        run_bench("ORB::detectAndCompute (2000)", filter, iterations, src_pixels,
+                  [&](int i) {
+                      orb->detectAndCompute(scene.frames_i420[i % kSeqLength].rowRange(0, kSrcHeight),
+                                            cv::noArray(), kps, desc);
+                  });
+        run_bench("TiledOrbExtractor::detect_and_compute (2000)", filter, iterations, src_pixels,
+                  [&](int i) {
+                      extractor.detect_and_compute(orb, scene.frames_i420[i % kSeqLength].rowRange(0, kSrcHeight),
+                                                   kps, desc);
+                  });
+    }
+
+    // ── Descriptor matching (frame ORB features vs. the next frame's) ───────
+    // "ns/pixel" is per descriptor pair here.
+    {
+        cv::Ptr<cv::ORB> orb = cv::ORB::create(4000);
+        std::vector<cv::KeyPoint> kps;
+        cv::Mat desc_a, desc_b;
+        orb->detectAndCompute(scene.frames_i420[0].rowRange(0, kSrcHeight),
+                              cv::noArray(), kps, desc_a);
+        orb->detectAndCompute(scene.frames_i420[1].rowRange(0, kSrcHeight),
+                              cv::noArray(), kps, desc_b);
+
+        const double pairs = static_cast<double>(desc_a.rows) * desc_b.rows;
+        std::cout << "[pipeline_bench] Matching " << desc_a.rows << " x " << desc_b.rows
+                  << " ORB descriptors, kernel: " << HammingMatcher::kernel_name(desc_a.cols)
+                  << "\n";
+
+        HammingMatcher matcher;
+        std::vector<cv::DMatch> matches;
+        run_bench("HammingMatcher::match (cross-check)", filter, iterations, pairs,
+                  [&](int) { matcher.match(desc_a, desc_b, matches); });
+        run_bench("HammingMatcher::ratio_match", filter, iterations, pairs,
+                  [&](int) { matcher.ratio_match(desc_a, desc_b, 0.75f, matches); });
+
+        LshIndex index;
+        if (index.build(desc_b)) {
+            run_bench("LshIndex::match (cross-check)", filter, iterations, pairs,
+                      [&](int) { index.match(desc_a, matches); });
+            run_bench("LshIndex::ratio_match", filter, iterations, pairs,
+                      [&](int) { index.ratio_match(desc_a, 0.75f, matches); });
+        }
+
+        cv::BFMatcher bf_cross(cv::NORM_HAMMING, true);
+        cv::BFMatcher bf_knn(cv::NORM_HAMMING, false);
+        std::vector<std::vector<cv::DMatch>> knn;
+        run_bench("cv::BFMatcher::match (cross-check)", filter, iterations, pairs,
+                  [&](int) { bf_cross.match(desc_a, desc_b, matches); });
+        run_bench("cv::BFMatcher::knnMatch (k=2)", filter, iterations, pairs,
+                  [&](int) { bf_knn.knnMatch(desc_a, desc_b, knn, 2); });
+    }
+
+    // ── Model fitting (synthetic matches, 40% outliers) ─────────────────────
+    // "ns/pixel" is per correspondence here.
+    {
+        const int         n = 1000;
+        const cv::Matx33d H_true(1.01, -0.02, 14.0, 0.015, 0.99, -9.0, 2e-6, -1e-6, 1.0);
+        cv::RNG           rng(7);
+        std::vector<cv::Point2f> src(n), dst(n);
+        std::vector<float>       quality(n);
+        for (auto& p : src) p = cv::Point2f(rng.uniform(0.f, (float)kSrcWidth),
+                                            rng.uniform(0.f, (float)kSrcHeight));
+        cv::perspectiveTransform(src, dst, H_true);
+        for (int i = 0; i < n; ++i) {
+            if (i % 5 < 2) {
+                dst[i]     = cv::Point2f(rng.uniform(0.f, (float)kSrcWidth),
+                                         rng.uniform(0.f, (float)kSrcHeight));
+                quality[i] = rng.uniform(30.f, 80.f);
+            } else {
+                dst[i]    += cv::Point2f((float)rng.gaussian(0.5), (float)rng.gaussian(0.5));
+                quality[i] = rng.uniform(0.f, 50.f);
+            }
+        }
+        std::cout << "[pipeline_bench] Model fitting on " << n << " correspondences, kernel: "
+                  << RobustEstimator::kernel_name() << "\n";
+
+        RobustEstimator    estimator;
+        cv::Matx33d        H;
+        std::vector<uchar> mask;
+        run_bench("RobustEstimator::estimate (homography, PROSAC)", filter, iterations, n,
+                  [&](int) { estimator.estimate(src, dst, quality, H, &mask); });
+        run_bench("RobustEstimator::estimate (homography, RANSAC)", filter, iterations, n,
+                  [&](int) { estimator.estimate(src, dst, {}, H, &mask); });
+        estimator.params.model = MotionModel::AffinePartial;
+        run_bench("RobustEstimator::estimate (affine partial)", filter, iterations, n,
+                  [&](int) { estimator.estimate(src, dst, quality, H, &mask); });
+
+        cv::Mat cv_mask;
+        run_bench("cv::findHomography (RANSAC)", filter, iterations, n,
+                  [&](int) { cv::findHomography(src, dst, cv::RANSAC, 3.0, cv_mask); });
+        run_bench("cv::estimateAffinePartial2D", filter, iterations, n,
+                  [&](int) { cv::estimateAffinePartial2D(src, dst, cv_mask); });
+    }
+
+    // ── Stabilizers (stateful: each call sees the next frame) ────────────────
+    for (bool deferred : { false, true }) {
+        const std::string suffix = deferred ? " (deferred warp)" : " (full warp)";
+
+        OFStabilizer of;
+        of.set_deferred_warp(deferred);
+        if (of.init("", "")) {
+            run_bench("OFStabilizer::stabilize" + suffix, filter, iterations, src_pixels,
+                      [&](int i) { of.stabilize(make_raw(scene, i), centre_detection); });
+        }
+
+        EDRansacStabilizer ed;
+        ed.set_deferred_warp(deferred);
+        if (ed.init("", "")) {
+            run_bench("EDRansacStabilizer::stabilize" + suffix, filter, iterations, src_pixels,
+                      [&](int i) { ed.stabilize(make_raw(scene, i), centre_detection); });
+        }
+
+        for (const char* config : { "", "rotation_scale=1" }) {
+            PhaseCorrStabilizer pc;
+            pc.set_deferred_warp(deferred);
+            if (pc.init(config, "")) {
+                const std::string variant = *config ? " rot+scale" : "";
+                run_bench("PhaseCorrStabilizer::stabilize" + variant + suffix, filter,
+                          iterations, src_pixels,
+                          [&](int i) { pc.stabilize(make_raw(scene, i), centre_detection); });
+            }
+        }
+
+        // Synthetic 200 Hz gyro sidecar: slow wobble about all three axes
+        const std::string sidecar =
+            (std::filesystem::temp_directory_path() / "pipeline_bench.gyro.csv").string();
+        {
+            std::FILE* f = std::fopen(sidecar.c_str(), "w");
+            if (f) {
+                std::fprintf(f, "t_ns,wx,wy,wz\n");
+                for (int k = 0; k <= 200 * 120; ++k) {
+                    const double t = k / 200.0;
+                    std::fprintf(f, "%lld,%f,%f,%f\n", static_cast<long long>(k) * 5'000'000,
+                                 0.02 * std::sin(3.1 * t), 0.02 * std::sin(2.3 * t),
+                                 0.01 * std::sin(1.7 * t));
+                }
+                std::fclose(f);
+            }
+        }
+        for (const char* config : { "", "refine=1" }) {
+            TelemetryStabilizer ts;
+            ts.set_deferred_warp(deferred);
+            if (ts.init(config, sidecar)) {
+                const std::string variant = *config ? " refine" : "";
+                run_bench("TelemetryStabilizer::stabilize" + variant + suffix, filter,
+                          iterations, src_pixels,
+                          [&](int i) { ts.stabilize(make_raw(scene, i), centre_detection); });
+            }
+        }
+    }
+
+    // ── Cropper ──────────────────────────────────────────────────────────────
+    {
+        StubCropper cropper;
+
+        StabilizedFrame plain;
+        plain.data             = scene.frames_i420[0];
+        plain.format           = PixelFormat::I420;
+        plain.suggested_center = centre_detection.center;
+
+        StabilizedFrame pending = plain;
+        pending.warp_pending = true;
+        pending.warp         = cv::Matx33d(0.9999, -0.0087, 10.0,
+                                           0.0087,  0.9999, -6.0,
+                                           0.0,     0.0,    1.0);
+        pending.warp_affine  = true;
+
+        run_bench("StubCropper::crop", filter, iterations, out_pixels,
+                  [&](int) { cropper.crop(plain, kOutWidth, kOutHeight); });
+        run_bench("StubCropper::crop (warp ROI)", filter, iterations, out_pixels,
+                  [&](int) { cropper.crop(pending, kOutWidth, kOutHeight); });
+    }
+
+    // ── Encoder ──────────────────────────────────────────────────────────────
+    // Measures the appsrc push (copy + any backpressure from x264), not the
+    // asynchronous encode itself.
+    {
+        GstreamerFileOutput output;
+        const std::string config = output_path + ":x264:30:" +
+                                   std::to_string(kOutWidth) + "x" +
+                                   std::to_string(kOutHeight);
+        if (output.init(config)) {
+            StubCropper  cropper;
+            StabilizedFrame sf;
+            sf.data             = scene.frames_i420[0];
+            sf.format           = PixelFormat::I420;
+            sf.suggested_center = centre_detection.center;
+            CroppedFrame cropped = cropper.crop(sf, kOutWidth, kOutHeight);
+
+            run_bench("GstreamerFileOutput::write_frame", filter, iterations, out_pixels,
+                      [&](int i) {
+                          cropped.pts_ns = static_cast<std::int64_t>(i) * 33'333'333;
+                          output.write_frame(cropped);
+                      });
+            output.close();
+        } else {
+            std::cerr << "[pipeline_bench] Skipping encoder benchmark (init failed).\n";
+        }
+        std::remove(output_path.c_str());
+    }
+
+    for (const std::string& path : reference_paths) {
+        std::remove(path.c_str());
+        std::remove(reference_cache_path(path, "orb").c_str());
+        std::remove(reference_cache_path(path, "brisk").c_str());
+    }
+    cv::Mat::setDefaultAllocator(nullptr);
+
+    print_results();
+    return 0;
+}
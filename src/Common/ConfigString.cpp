@@ -0,0 +1,102 @@
+#include "Common/ConfigString.h"
+
+#include <algorithm>
+#include <cctype>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+std::string trim(const std::string& s)
+{
+    auto not_space = [](unsigned char c) { return !std::isspace(c); };
+    const auto begin = std::find_if(s.begin(), s.end(), not_space);
+    const auto end   = std::find_if(s.rbegin(), s.rend(), not_space).base();
+    return begin < end ? std::string(begin, end) : std::string();
+}
+
+// Parse the whole of `text` as a T; false on trailing garbage.
+template <typename T>
+bool parse(const std::string& text, T& out)
+{
+    std::istringstream ss(text);
+    T value{};
+    ss >> value;
+    if (ss.fail() || !(ss >> std::ws).eof()) return false;
+    out = value;
+    return true;
+}
+
+} // namespace
+
+ConfigString::ConfigString(const std::string& text)
+{
+    std::stringstream ss(text);
+    std::string       item;
+    while (std::getline(ss, item, ',')) {
+        const auto eq  = item.find('=');
+        const std::string key = trim(item.substr(0, eq));
+        if (key.empty()) continue;
+        values_[key] = eq == std::string::npos ? "true" : trim(item.substr(eq + 1));
+    }
+}
+
+bool ConfigString::has(const std::string& key) const
+{
+    return values_.count(key) != 0;
+}
+
+std::string ConfigString::get(const std::string& key, const std::string& fallback) const
+{
+    const auto it = values_.find(key);
+    if (it == values_.end()) return fallback;
+    used_.insert(key);
+    return it->second;
+}
+
+float ConfigString::get_float(const std::string& key, float fallback) const
+{
+    const std::string text = get(key, "");
+    float value = fallback;
+    if (!text.empty() && !parse(text, value)) {
+        std::cerr << "[ConfigString] '" << key << "=" << text << "' is not a number — using "
+                  << fallback << "\n";
+        return fallback;
+    }
+    return value;
+}
+
+int ConfigString::get_int(const std::string& key, int fallback) const
+{
+    const std::string text = get(key, "");
+    int value = fallback;
+    if (!text.empty() && !parse(text, value)) {
+        std::cerr << "[ConfigString] '" << key << "=" << text << "' is not an integer — using "
+                  << fallback << "\n";
+        return fallback;
+    }
+    return value;
+}
+
+bool ConfigString::get_bool(const std::string& key, bool fallback) const
+{
+    std::string text = get(key, "");
+    std::transform(text.begin(), text.end(), text.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    if (text.empty()) return fallback;
+    if (text == "1" || text == "true" || text == "on" || text == "yes") return true;
+    if (text == "0" || text == "false" || text == "off" || text == "no") return false;
+
+    std::cerr << "[ConfigString] '" << key << "=" << text << "' is not a boolean — using "
+              << std::boolalpha << fallback << "\n";
+    return fallback;
+}
+
+void ConfigString::warn_unused(const std::string& owner) const
+{
+    for (const auto& kv : values_) {
+        if (!used_.count(kv.first)) {
+            std::cerr << owner << " Unknown option '" << kv.first << "' ignored\n";
+        }
+    }
+}
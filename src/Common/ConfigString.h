@@ -0,0 +1,42 @@
+#pragma once
+
+#include <map>
+#include <set>
+#include <string>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ConfigString
+//
+// "key=value,key=value" option strings, as passed to IFeatureDetector::init
+// in model_config, so detectors can be tuned at runtime without rebuilding.
+//
+//   ConfigString cfg("coarse_scale=0.25, refine_margin=2");
+//   coarseScale = cfg.get_float("coarse_scale", coarseScale);
+//   cfg.warn_unused("[ORBDetector]");
+//
+// Design:
+//   - Whitespace around keys and values is ignored; a key without '=' is
+//     read as "true"
+//   - A value that does not parse logs a warning and the default is kept,
+//     so a typo never aborts start-up
+//   - Keys that were never read are reported by warn_unused(), which
+//     catches misspelt option names
+// ─────────────────────────────────────────────────────────────────────────────
+
+class ConfigString {
+public:
+    explicit ConfigString(const std::string& text);
+
+    bool        has(const std::string& key) const;
+    std::string get(const std::string& key, const std::string& fallback) const;
+    float       get_float(const std::string& key, float fallback) const;
+    int         get_int(const std::string& key, int fallback) const;
+    bool        get_bool(const std::string& key, bool fallback) const;
+
+    // Log keys that no getter asked for, prefixed with `owner`.
+    void        warn_unused(const std::string& owner) const;
+
+private:
+    std::map<std::string, std::string> values_;
+    mutable std::set<std::string>      used_;
+};
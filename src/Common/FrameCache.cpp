@@ -0,0 +1,69 @@
+#include "Common/FrameCache.h"
+#include "Common/ImageOps.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video.hpp>
+
+namespace {
+
+void ensure_gradients(const RawFrame& frame)
+{
+    FrameCache& c = frame.cache;
+    if (!c.grad_x.empty()) return;
+
+    const cv::Mat& gray = cached_gray(frame);
+    cv::Sobel(gray, c.grad_x, CV_16S, 1, 0, 3);
+    cv::Sobel(gray, c.grad_y, CV_16S, 0, 1, 3);
+}
+
+} // namespace
+
+const cv::Mat& cached_gray(const RawFrame& frame)
+{
+    FrameCache& c = frame.cache;
+    if (c.gray.empty()) {
+        c.gray = luma_view(frame.data, frame.format);
+    }
+    return c.gray;
+}
+
+const std::vector<cv::Mat>& cached_pyramid(const RawFrame& frame, int levels)
+{
+    FrameCache& c = frame.cache;
+    if (c.pyramid.empty()) {
+        c.pyramid.push_back(cached_gray(frame));
+    }
+    while (static_cast<int>(c.pyramid.size()) < levels) {
+        cv::Mat next;
+        cv::pyrDown(c.pyramid.back(), next);
+        c.pyramid.push_back(next);
+    }
+    return c.pyramid;
+}
+
+const std::vector<cv::Mat>& cached_lk_pyramid(const RawFrame& frame,
+                                              cv::Size        win,
+                                              int             max_level)
+{
+    FrameCache& c = frame.cache;
+    if (c.lk_pyramid.empty() || c.lk_win != win || c.lk_max_level != max_level) {
+        c.lk_pyramid.clear();
+        cv::buildOpticalFlowPyramid(cached_gray(frame), c.lk_pyramid,
+                                    win, max_level, true);
+        c.lk_win       = win;
+        c.lk_max_level = max_level;
+    }
+    return c.lk_pyramid;
+}
+
+const cv::Mat& cached_grad_x(const RawFrame& frame)
+{
+    ensure_gradients(frame);
+    return frame.cache.grad_x;
+}
+
+const cv::Mat& cached_grad_y(const RawFrame& frame)
+{
+    ensure_gradients(frame);
+    return frame.cache.grad_y;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <vector>
+
+struct RawFrame;
+
+// ─────────────────────────────────────────────────────────────────────────────
+// FrameCache
+//
+// Derived images and features attached to a RawFrame (RawFrame::cache).
+// Every detector/stabilizer asks for what it needs through the accessors
+// below; whichever stage asks first pays for it, every later stage gets the
+// cached result — so each derivative is computed at most once per frame.
+//
+// Design:
+//   - The cache is `mutable` on RawFrame, so stages that only get a
+//     const RawFrame& (stabilizers) can still fill it without const_cast
+//   - Not thread-safe: a RawFrame is owned by one pipeline stage at a time
+//   - Mats share their buffers, so copying a RawFrame shares the cache
+//     contents rather than duplicating pixels
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct FrameCache {
+    // ── Images ───────────────────────────────────────────────────────────────
+    cv::Mat              gray;              // 8-bit luma (view for I420/Gray)
+    std::vector<cv::Mat> pyramid;           // pyrDown levels, [0] == gray
+    std::vector<cv::Mat> lk_pyramid;        // buildOpticalFlowPyramid output
+    cv::Size             lk_win;
+    int                  lk_max_level = -1;
+    cv::Mat              grad_x;            // CV_16S Sobel derivatives of gray
+    cv::Mat              grad_y;
+
+    // ── Features (full-frame ORB, shared detector → stabilizer) ──────────────
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat                   descriptors;
+    bool                      features_computed = false;
+};
+
+// 8-bit single-channel luma of the frame.
+const cv::Mat& cached_gray(const RawFrame& frame);
+
+// Gaussian pyramid with at least `levels` levels (level 0 is the gray image).
+const std::vector<cv::Mat>& cached_pyramid(const RawFrame& frame, int levels);
+
+// Pyramid as built by cv::buildOpticalFlowPyramid(gray, ..., win, max_level)
+// with derivatives, ready to pass straight to calcOpticalFlowPyrLK. Rebuilt
+// if requested with different parameters.
+const std::vector<cv::Mat>& cached_lk_pyramid(const RawFrame& frame,
+                                              cv::Size        win,
+                                              int             max_level);
+
+// Horizontal / vertical Sobel gradients of the gray image (both built on
+// first use of either).
+const cv::Mat& cached_grad_x(const RawFrame& frame);
+const cv::Mat& cached_grad_y(const RawFrame& frame);
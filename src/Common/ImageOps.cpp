@@ -0,0 +1,185 @@
+#include "Common/ImageOps.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <stdexcept>
+
+namespace {
+
+// Transform `M` expressed in luma pixels, re-expressed for a plane subsampled
+// by 2 in both directions: S·M·S⁻¹ with S = diag(0.5, 0.5, 1).
+cv::Matx33d to_half_res(const cv::Matx33d& M)
+{
+    return { M(0, 0),       M(0, 1),       M(0, 2) * 0.5,
+             M(1, 0),       M(1, 1),       M(1, 2) * 0.5,
+             M(2, 0) * 2.0, M(2, 1) * 2.0, M(2, 2) };
+}
+
+// Warp one plane into the already-allocated `dst` (size taken from dst).
+void warp_plane(const cv::Mat& src, cv::Mat& dst, const cv::Matx33d& M,
+                bool affine, int border_mode)
+{
+    if (affine) {
+        const cv::Matx23d A = M.get_minor<2, 3>(0, 0);
+        cv::warpAffine(src, dst, A, dst.size(), cv::INTER_LINEAR, border_mode);
+    } else {
+        cv::warpPerspective(src, dst, M, dst.size(), cv::INTER_LINEAR, border_mode);
+    }
+}
+
+// Chroma is subsampled by 2 — keep I420 ROIs on even luma pixels.
+void align_even(cv::Rect& roi)
+{
+    roi.x      &= ~1;
+    roi.y      &= ~1;
+    roi.width  &= ~1;
+    roi.height &= ~1;
+}
+
+cv::Mat to_bgr(const cv::Mat& data, PixelFormat format)
+{
+    cv::Mat bgr;
+    switch (format) {
+        case PixelFormat::BGR:
+            return data;
+        case PixelFormat::Gray:
+            cv::cvtColor(data, bgr, cv::COLOR_GRAY2BGR);
+            return bgr;
+        case PixelFormat::I420:
+        default:
+            cv::cvtColor(data, bgr, cv::COLOR_YUV2BGR_I420);
+            return bgr;
+    }
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Plane access
+// ─────────────────────────────────────────────────────────────────────────────
+
+cv::Size image_size(const cv::Mat& data, PixelFormat format)
+{
+    if (format == PixelFormat::I420) {
+        return { data.cols, data.rows * 2 / 3 };
+    }
+    return data.size();
+}
+
+cv::Mat luma_view(const cv::Mat& data, PixelFormat format)
+{
+    switch (format) {
+        case PixelFormat::I420:
+            return data.rowRange(0, data.rows * 2 / 3);
+        case PixelFormat::Gray:
+            return data;
+        case PixelFormat::BGR:
+        default: {
+            cv::Mat gray;
+            cv::cvtColor(data, gray, cv::COLOR_BGR2GRAY);
+            return gray;
+        }
+    }
+}
+
+I420Planes i420_planes(const cv::Mat& data)
+{
+    if (data.type() != CV_8UC1 || !data.isContinuous() ||
+        data.rows % 3 != 0 || data.cols % 2 != 0) {
+        throw std::invalid_argument("[ImageOps] Not a packed I420 buffer.");
+    }
+
+    const int w = data.cols;
+    const int h = data.rows * 2 / 3;
+    const std::size_t y_bytes = static_cast<std::size_t>(w) * h;
+    const std::size_t c_bytes = y_bytes / 4;
+
+    I420Planes p;
+    p.buffer = data;
+    p.y = data.rowRange(0, h);
+    p.u = cv::Mat(h / 2, w / 2, CV_8UC1, data.data + y_bytes);
+    p.v = cv::Mat(h / 2, w / 2, CV_8UC1, data.data + y_bytes + c_bytes);
+    return p;
+}
+
+I420Planes i420_allocate(cv::Size size)
+{
+    return i420_planes(cv::Mat(size.height * 3 / 2, size.width, CV_8UC1));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Warp / crop
+// ─────────────────────────────────────────────────────────────────────────────
+
+cv::Mat warp_image(const cv::Mat&     src,
+                   PixelFormat        format,
+                   const cv::Matx33d& M,
+                   cv::Size           dsize,
+                   bool               affine,
+                   int                border_mode)
+{
+    if (format != PixelFormat::I420) {
+        cv::Mat dst(dsize, src.type());
+        warp_plane(src, dst, M, affine, border_mode);
+        return dst;
+    }
+
+    const I420Planes s = i420_planes(src);
+    I420Planes       d = i420_allocate(dsize);
+    const cv::Matx33d Mc = to_half_res(M);
+
+    warp_plane(s.y, d.y, M,  affine, border_mode);
+    warp_plane(s.u, d.u, Mc, affine, border_mode);
+    warp_plane(s.v, d.v, Mc, affine, border_mode);
+    return d.buffer;
+}
+
+cv::Mat crop_to_bgr(const cv::Mat& data, PixelFormat format, cv::Rect& roi)
+{
+    switch (format) {
+        case PixelFormat::BGR:
+            return data(roi).clone();
+
+        case PixelFormat::Gray:
+            return to_bgr(data(roi), format);
+
+        case PixelFormat::I420:
+        default: {
+            align_even(roi);
+
+            const cv::Rect  croi(roi.x / 2, roi.y / 2, roi.width / 2, roi.height / 2);
+            const I420Planes s = i420_planes(data);
+            I420Planes       d = i420_allocate(roi.size());
+
+            s.y(roi).copyTo(d.y);
+            s.u(croi).copyTo(d.u);
+            s.v(croi).copyTo(d.v);
+
+            return to_bgr(d.buffer, format);
+        }
+    }
+}
+
+cv::Mat warp_crop_to_bgr(const cv::Mat&     data,
+                         PixelFormat        format,
+                         const cv::Matx33d& warp,
+                         bool               affine,
+                         int                border_mode,
+                         cv::Rect&          roi)
+{
+    if (format == PixelFormat::I420) {
+        align_even(roi);
+    }
+
+    // Output pixel (u, v) of the crop is stabilized pixel (u + x, v + y), so
+    // the source → crop transform is T(-roi.tl) · warp. warpAffine /
+    // warpPerspective inverse-map every destination pixel, so only
+    // roi.area() pixels are sampled.
+    const cv::Matx33d to_roi(1.0, 0.0, -static_cast<double>(roi.x),
+                             0.0, 1.0, -static_cast<double>(roi.y),
+                             0.0, 0.0, 1.0);
+
+    const cv::Mat local = warp_image(data, format, to_roi * warp,
+                                     roi.size(), affine, border_mode);
+    return to_bgr(local, format);
+}
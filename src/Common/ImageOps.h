@@ -0,0 +1,64 @@
+#pragma once
+
+#include "interfaces.h"
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ImageOps
+//
+// Format-aware helpers for frames whose pixels may be BGR, Gray or packed
+// I420 (see PixelFormat in interfaces.h).
+//
+// Design:
+//   - luma_view() is zero-copy for Gray/I420 — analysis stages never pay for
+//     a colour conversion unless the source really is BGR
+//   - warp_image() resamples every plane of the frame (chroma planes with
+//     the transform rescaled to their half resolution)
+//   - crop_to_bgr() / warp_crop_to_bgr() are the only places I420/Gray
+//     pixels become BGR, so the conversion runs on the output-sized region
+//   - warp_crop_to_bgr() inverse-maps just the output ROI through a deferred
+//     stabilization warp instead of resampling the full source frame
+// ─────────────────────────────────────────────────────────────────────────────
+
+// Zero-copy plane views into a packed I420 buffer. `buffer` holds a
+// reference so the views stay valid for the lifetime of this struct.
+struct I420Planes {
+    cv::Mat buffer;
+    cv::Mat y;      // width   x height
+    cv::Mat u;      // width/2 x height/2
+    cv::Mat v;      // width/2 x height/2
+};
+
+// Picture size in pixels (not the Mat size — I420 has 3/2 as many rows).
+cv::Size image_size(const cv::Mat& data, PixelFormat format);
+
+// 8-bit single-channel luma. Zero-copy view for Gray/I420, converted for BGR.
+cv::Mat luma_view(const cv::Mat& data, PixelFormat format);
+
+// Split a packed I420 Mat into plane views.
+I420Planes i420_planes(const cv::Mat& data);
+
+// Allocate a packed I420 buffer for a `size` picture (width/height even).
+I420Planes i420_allocate(cv::Size size);
+
+// Resample a whole frame through the 3x3 transform `M` (source → output),
+// keeping its pixel format. Affine transforms use warpAffine on the top two
+// rows of M.
+cv::Mat warp_image(const cv::Mat&     src,
+                   PixelFormat        format,
+                   const cv::Matx33d& M,
+                   cv::Size           dsize,
+                   bool               affine,
+                   int                border_mode);
+
+// Copy `roi` out of the frame and convert it to BGR. For I420 the ROI is
+// first aligned down to even coordinates/size; `roi` is updated in place.
+cv::Mat crop_to_bgr(const cv::Mat& data, PixelFormat format, cv::Rect& roi);
+
+// Equivalent to crop_to_bgr(warp_image(data, ..., warp, ...), roi) but only
+// the ROI pixels are resampled. `roi` is in warped (stabilized) coordinates.
+cv::Mat warp_crop_to_bgr(const cv::Mat&     data,
+                         PixelFormat        format,
+                         const cv::Matx33d& warp,
+                         bool               affine,
+                         int                border_mode,
+                         cv::Rect&          roi);
@@ -0,0 +1,99 @@
+#include "Common/MotionFilter.h"
+
+#include <algorithm>
+#include <cmath>
+
+MotionFilter::MotionFilter()
+    : kf_(4, 2, 0, CV_32F)
+{
+    // Measurements observe the position only
+    kf_.measurementMatrix = cv::Mat::zeros(2, 4, CV_32F);
+    kf_.measurementMatrix.at<float>(0, 0) = 1.f;
+    kf_.measurementMatrix.at<float>(1, 1) = 1.f;
+}
+
+void MotionFilter::reset()
+{
+    initialized_ = false;
+    last_pts_ns_ = 0;
+}
+
+cv::Point2f MotionFilter::predict(std::int64_t pts_ns)
+{
+    const std::int64_t prev_pts_ns = last_pts_ns_;
+    last_pts_ns_ = pts_ns;
+    if (!initialized_) return position();
+
+    // Step from the timestamps; one nominal frame if they are missing or
+    // not increasing
+    float dt = 1.f / default_fps;
+    if (pts_ns > prev_pts_ns && prev_pts_ns != 0) {
+        dt = static_cast<float>(pts_ns - prev_pts_ns) * 1e-9f;
+    }
+
+    // x' = x + v·dt
+    cv::setIdentity(kf_.transitionMatrix);
+    kf_.transitionMatrix.at<float>(0, 2) = dt;
+    kf_.transitionMatrix.at<float>(1, 3) = dt;
+
+    // Discrete white-acceleration noise per axis: σa² · [dt⁴/4 dt³/2; dt³/2 dt²]
+    const float q  = acceleration_sigma * acceleration_sigma;
+    const float pp = q * dt * dt * dt * dt / 4.f;
+    const float pv = q * dt * dt * dt / 2.f;
+    const float vv = q * dt * dt;
+    kf_.processNoiseCov = cv::Mat::zeros(4, 4, CV_32F);
+    for (int axis = 0; axis < 2; ++axis) {
+        kf_.processNoiseCov.at<float>(axis, axis)         = pp;
+        kf_.processNoiseCov.at<float>(axis, axis + 2)     = pv;
+        kf_.processNoiseCov.at<float>(axis + 2, axis)     = pv;
+        kf_.processNoiseCov.at<float>(axis + 2, axis + 2) = vv;
+    }
+
+    // predict() also copies the prediction into statePost/errorCovPost, so
+    // position() and uncertainty_radius() reflect it until correct()
+    kf_.predict();
+    return position();
+}
+
+cv::Point2f MotionFilter::correct(cv::Point2f measured)
+{
+    const float r = measurement_sigma * measurement_sigma;
+
+    if (!initialized_) {
+        kf_.statePost = (cv::Mat_<float>(4, 1) << measured.x, measured.y, 0.f, 0.f);
+        const float v = initial_speed * initial_speed;
+        kf_.errorCovPost = (cv::Mat_<float>(4, 4) << r, 0, 0, 0,
+                                                     0, r, 0, 0,
+                                                     0, 0, v, 0,
+                                                     0, 0, 0, v);
+        initialized_ = true;
+        return measured;
+    }
+
+    cv::setIdentity(kf_.measurementNoiseCov, cv::Scalar::all(r));
+    kf_.correct((cv::Mat_<float>(2, 1) << measured.x, measured.y));
+    return position();
+}
+
+cv::Point2f MotionFilter::position() const
+{
+    return { kf_.statePost.at<float>(0), kf_.statePost.at<float>(1) };
+}
+
+cv::Point2f MotionFilter::velocity() const
+{
+    return { kf_.statePost.at<float>(2), kf_.statePost.at<float>(3) };
+}
+
+float MotionFilter::uncertainty_radius(float sigmas) const
+{
+    if (!initialized_) return 0.f;
+
+    // Largest eigenvalue of the 2x2 position covariance
+    const cv::Mat& P  = kf_.errorCovPost;
+    const float    a  = P.at<float>(0, 0);
+    const float    b  = P.at<float>(0, 1);
+    const float    d  = P.at<float>(1, 1);
+    const float    l1 = 0.5f * (a + d) + std::sqrt(0.25f * (a - d) * (a - d) + b * b);
+    return sigmas * std::sqrt(std::max(l1, 0.f));
+}
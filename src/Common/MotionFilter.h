@@ -0,0 +1,62 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/video.hpp>
+
+#include <cstdint>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// MotionFilter
+//
+// Constant-velocity Kalman filter for an object centre in source pixels.
+// State (x, y, vx, vy); measurements (x, y).
+//
+//   filter.predict(frame.pts_ns);                 // every frame
+//   if (found) centre = filter.correct(measured); // when detected
+//   radius = filter.uncertainty_radius();         // size the search window
+//
+// Design:
+//   - Time steps come from frame timestamps, so skipped or dropped frames
+//     are handled by a longer step instead of being treated as one frame
+//   - Process noise is white acceleration (acceleration_sigma, px/s²): the
+//     covariance grows with every predict() that is not followed by a
+//     correct(), so uncertainty_radius() widens on its own while the object
+//     is missed and collapses again once it is found
+//   - Unlike an EMA the smoothed centre does not lag a target moving at
+//     constant speed, and predict() gives a centre for frames without a
+//     measurement
+// ─────────────────────────────────────────────────────────────────────────────
+
+class MotionFilter {
+public:
+    float acceleration_sigma = 400.f;   // px/s², how quickly the target can change velocity
+    float measurement_sigma  = 3.f;     // px, detector centre noise
+    float initial_speed      = 500.f;   // px/s, velocity std before the second measurement
+    float default_fps        = 30.f;    // step size when timestamps are missing
+
+    MotionFilter();
+
+    // Forget the track; the next correct() starts a new one.
+    void        reset();
+    bool        initialized() const { return initialized_; }
+
+    // Advance the state to `pts_ns`. Returns the predicted centre (the last
+    // centre if not initialized).
+    cv::Point2f predict(std::int64_t pts_ns);
+
+    // Fuse a measured centre (starts the track if not initialized). Returns
+    // the filtered centre.
+    cv::Point2f correct(cv::Point2f measured);
+
+    cv::Point2f position() const;
+    cv::Point2f velocity() const;           // px/s
+
+    // Radius holding the true centre with `sigmas` standard deviations along
+    // the least certain direction.
+    float       uncertainty_radius(float sigmas = 3.f) const;
+
+private:
+    cv::KalmanFilter kf_;
+    bool             initialized_ = false;
+    std::int64_t     last_pts_ns_ = 0;
+};
@@ -0,0 +1,236 @@
+#include "Common/ReferenceModelCache.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace {
+
+// ── File layout (native endianness, all fields 4- or 8-byte aligned) ─────────
+//
+//   Header
+//   params      char[params_len], zero-padded to a multiple of 8
+//   keypoints   PackedKeyPoint[keypoint_count]
+//   descriptors desc_rows * desc_cols * elemSize(desc_type) bytes
+
+constexpr char          kMagic[8] = { 'A', 'A', 'R', 'E', 'F', 'M', 'D', 'L' };
+constexpr std::uint32_t kVersion  = 1;
+
+struct Header {
+    char          magic[8];
+    std::uint32_t version;
+    std::uint32_t params_len;
+    std::uint64_t source_hash;
+    std::uint64_t source_size;
+    std::int32_t  width;
+    std::int32_t  height;
+    std::uint32_t keypoint_count;
+    std::int32_t  desc_rows;
+    std::int32_t  desc_cols;
+    std::int32_t  desc_type;
+};
+
+struct PackedKeyPoint {
+    float        x, y, size, angle, response;
+    std::int32_t octave, class_id;
+};
+
+std::size_t padded(std::size_t n) { return (n + 7) & ~std::size_t{ 7 }; }
+
+// Read-only mapping of a whole file, unmapped on destruction.
+class MappedFile {
+public:
+    explicit MappedFile(const std::string& path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0) return;
+
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0) {
+            void* p = ::mmap(nullptr, static_cast<std::size_t>(st.st_size),
+                             PROT_READ, MAP_PRIVATE, fd, 0);
+            if (p != MAP_FAILED) {
+                data_ = static_cast<const std::uint8_t*>(p);
+                size_ = static_cast<std::size_t>(st.st_size);
+            }
+        }
+        ::close(fd);   // the mapping stays valid
+    }
+
+    ~MappedFile()
+    {
+        if (data_) ::munmap(const_cast<std::uint8_t*>(data_), size_);
+    }
+
+    MappedFile(const MappedFile&)            = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    const std::uint8_t* data() const { return data_; }
+    std::size_t         size() const { return size_; }
+
+private:
+    const std::uint8_t* data_ = nullptr;
+    std::size_t         size_ = 0;
+};
+
+std::uint64_t fnv1a(const std::uint8_t* data, std::size_t size)
+{
+    std::uint64_t h = 0xcbf29ce484222325ULL;
+    for (std::size_t i = 0; i < size; ++i) {
+        h ^= data[i];
+        h *= 0x100000001b3ULL;
+    }
+    return h;
+}
+
+// Hash and size of the source image file; false if it cannot be read.
+bool source_fingerprint(const std::string& image_path, std::uint64_t& hash, std::uint64_t& size)
+{
+    const MappedFile image(image_path);
+    if (!image.data()) return false;
+    hash = fnv1a(image.data(), image.size());
+    size = image.size();
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Public API
+// ─────────────────────────────────────────────────────────────────────────────
+
+std::string reference_cache_path(const std::string& image_path, const std::string& tag)
+{
+    return image_path + "." + tag + ".refmodel";
+}
+
+bool load_reference_model(const std::string& image_path,
+                          const std::string& tag,
+                          const std::string& params,
+                          ReferenceModel&    model)
+{
+    const MappedFile cache(reference_cache_path(image_path, tag));
+    if (!cache.data() || cache.size() < sizeof(Header)) return false;
+
+    Header h;
+    std::memcpy(&h, cache.data(), sizeof(Header));
+    if (std::memcmp(h.magic, kMagic, sizeof(kMagic)) != 0 || h.version != kVersion) return false;
+
+    // Cheap checks first: parameters, then the file layout, then the hash.
+    const char* stored_params = reinterpret_cast<const char*>(cache.data() + sizeof(Header));
+    if (h.params_len != params.size() || sizeof(Header) + h.params_len > cache.size() ||
+        std::memcmp(stored_params, params.data(), params.size()) != 0) {
+        return false;
+    }
+
+    if (h.desc_rows < 0 || h.desc_cols < 0 || h.width <= 0 || h.height <= 0) return false;
+    const std::size_t kp_offset   = sizeof(Header) + padded(h.params_len);
+    const std::size_t kp_bytes    = std::size_t{ h.keypoint_count } * sizeof(PackedKeyPoint);
+    const std::size_t desc_offset = kp_offset + kp_bytes;
+    const std::size_t desc_bytes  = static_cast<std::size_t>(h.desc_rows) * h.desc_cols *
+                                    CV_ELEM_SIZE(h.desc_type);
+    if (desc_offset + desc_bytes != cache.size()) return false;
+
+    std::uint64_t hash = 0, size = 0;
+    if (!source_fingerprint(image_path, hash, size) ||
+        hash != h.source_hash || size != h.source_size) {
+        return false;
+    }
+
+    model.image_size = { h.width, h.height };
+
+    model.keypoints.resize(h.keypoint_count);
+    for (std::uint32_t i = 0; i < h.keypoint_count; ++i) {
+        PackedKeyPoint p;
+        std::memcpy(&p, cache.data() + kp_offset + i * sizeof(PackedKeyPoint), sizeof(p));
+        model.keypoints[i] = cv::KeyPoint(cv::Point2f(p.x, p.y), p.size, p.angle, p.response,
+                                          p.octave, p.class_id);
+    }
+
+    // Copied out of the mapping: a few tens of KB, and the caller keeps it
+    // well past this function.
+    model.descriptors = cv::Mat(h.desc_rows, h.desc_cols, h.desc_type,
+                                const_cast<std::uint8_t*>(cache.data() + desc_offset)).clone();
+    return true;
+}
+
+bool save_reference_model(const std::string&    image_path,
+                          const std::string&    tag,
+                          const std::string&    params,
+                          const ReferenceModel& model)
+{
+    Header h{};
+    std::memcpy(h.magic, kMagic, sizeof(kMagic));
+    h.version        = kVersion;
+    h.params_len     = static_cast<std::uint32_t>(params.size());
+    h.width          = model.image_size.width;
+    h.height         = model.image_size.height;
+    h.keypoint_count = static_cast<std::uint32_t>(model.keypoints.size());
+    h.desc_rows      = model.descriptors.rows;
+    h.desc_cols      = model.descriptors.cols;
+    h.desc_type      = model.descriptors.type();
+    if (!source_fingerprint(image_path, h.source_hash, h.source_size)) return false;
+
+    const std::string path = reference_cache_path(image_path, tag);
+    const std::string tmp  = path + ".tmp" + std::to_string(::getpid());
+
+    {
+        std::ofstream out(tmp, std::ios::binary | std::ios::trunc);
+        if (!out) {
+            std::cerr << "[ReferenceModelCache] Cannot write " << tmp << "\n";
+            return false;
+        }
+
+        out.write(reinterpret_cast<const char*>(&h), sizeof(h));
+        out.write(params.data(), static_cast<std::streamsize>(params.size()));
+        const char zeros[8] = {};
+        out.write(zeros, static_cast<std::streamsize>(padded(params.size()) - params.size()));
+
+        for (const cv::KeyPoint& kp : model.keypoints) {
+            const PackedKeyPoint p{ kp.pt.x, kp.pt.y, kp.size, kp.angle, kp.response,
+                                    kp.octave, kp.class_id };
+            out.write(reinterpret_cast<const char*>(&p), sizeof(p));
+        }
+
+        const cv::Mat desc = model.descriptors.isContinuous() ? model.descriptors
+                                                              : model.descriptors.clone();
+        out.write(reinterpret_cast<const char*>(desc.data),
+                  static_cast<std::streamsize>(desc.total() * desc.elemSize()));
+
+        if (!out.flush()) {
+            std::remove(tmp.c_str());
+            std::cerr << "[ReferenceModelCache] Write failed: " << tmp << "\n";
+            return false;
+        }
+    }
+
+    if (std::rename(tmp.c_str(), path.c_str()) != 0) {
+        std::remove(tmp.c_str());
+        std::cerr << "[ReferenceModelCache] Cannot rename " << tmp << " to " << path << "\n";
+        return false;
+    }
+    return true;
+}
+
+std::string orb_params_key(const cv::Ptr<cv::ORB>& orb)
+{
+    std::ostringstream ss;
+    ss << "ORB nfeatures=" << orb->getMaxFeatures()
+       << " scale="        << orb->getScaleFactor()
+       << " nlevels="      << orb->getNLevels()
+       << " edge="         << orb->getEdgeThreshold()
+       << " first="        << orb->getFirstLevel()
+       << " wta_k="        << orb->getWTA_K()
+       << " score="        << static_cast<int>(orb->getScoreType())
+       << " patch="        << orb->getPatchSize()
+       << " fast="         << orb->getFastThreshold();
+    return ss.str();
+}
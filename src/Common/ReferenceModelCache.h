@@ -0,0 +1,59 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ReferenceModelCache
+//
+// Binary on-disk cache of a reference image's keypoints and descriptors, so
+// a restarted process skips decoding and describing the reference.
+//
+//   ReferenceModel model;
+//   const std::string params = orb_params_key(orb);
+//   if (!load_reference_model(path, "orb", params, model)) {
+//       ...detectAndCompute...
+//       save_reference_model(path, "orb", params, model);
+//   }
+//
+// Design:
+//   - The cache lives next to the image as <image>.<tag>.refmodel
+//   - It is valid only if the FNV-1a hash and size of the image file and
+//     the detector parameter string all match; anything else (edited
+//     image, changed nfeatures, truncated file, other version) is a miss
+//     and the caller recomputes
+//   - Both the image (for hashing) and the cache are read through mmap —
+//     no decode, no read() copies
+//   - Writes go to a temporary file that is renamed into place, so a
+//     process killed mid-write (or several processes racing at startup)
+//     never leaves a torn cache behind
+//   - Failures are never fatal: a cache that cannot be written only costs
+//     the next start its extraction time
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct ReferenceModel {
+    cv::Size                  image_size;
+    std::vector<cv::KeyPoint> keypoints;
+    cv::Mat                   descriptors;
+};
+
+// Cache file path for `image_path` and detector `tag` (e.g. "orb").
+std::string reference_cache_path(const std::string& image_path, const std::string& tag);
+
+// Fill `model` from the cache if it matches the image and `params`.
+bool load_reference_model(const std::string& image_path,
+                          const std::string& tag,
+                          const std::string& params,
+                          ReferenceModel&    model);
+
+// Write `model` to the cache (atomically). Returns false on I/O errors.
+bool save_reference_model(const std::string&    image_path,
+                          const std::string&    tag,
+                          const std::string&    params,
+                          const ReferenceModel& model);
+
+// Parameter string identifying an ORB configuration.
+std::string orb_params_key(const cv::Ptr<cv::ORB>& orb);
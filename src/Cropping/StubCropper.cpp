@@ -1,4 +1,5 @@
 #include "Cropping/StubCropper.h"
+#include "Common/ImageOps.h"
 
 cv::Rect StubCropper::compute_roi(cv::Point2f center,
                                    int src_w, int src_h,
@@ -22,13 +23,18 @@ cv::Rect StubCropper::compute_roi(cv::Point2f center,
 CroppedFrame StubCropper::crop(const StabilizedFrame& frame,
                                int out_w, int out_h)
 {
+    const cv::Size size = image_size(frame.data, frame.format);
     cv::Rect roi = compute_roi(
         frame.suggested_center,
-        frame.data.cols, frame.data.rows,
+        size.width, size.height,
         out_w, out_h);
 
+    // Only the output-sized region is resampled / converted to BGR.
     CroppedFrame cf;
-    cf.data    = frame.data(roi).clone();
+    cf.data    = frame.warp_pending
+        ? warp_crop_to_bgr(frame.data, frame.format, frame.warp,
+                           frame.warp_affine, frame.border_mode, roi)
+        : crop_to_bgr(frame.data, frame.format, roi);
     cf.src_roi = roi;
     cf.pts_ns  = frame.pts_ns;
     return cf;
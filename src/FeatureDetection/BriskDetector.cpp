@@ -1,38 +1,67 @@
 #include "FeatureDetection/BriskDetector.h"
+#include "Common/ConfigString.h"
+#include "Common/FrameCache.h"
+#include "Common/ReferenceModelCache.h"
 #include <opencv2/imgproc.hpp>
 #include <opencv2/imgcodecs.hpp>
+#include <algorithm>
 #include <iostream>
+#include <string>
+#include <utility>
 
 BriskDetector::BriskDetector()
-    // thresh = threshold (default 30, higher = fewer keypoints = faster)
-    // octaves = scale levels (default 3, lower = fewer scales = faster)
-    : brisk_(cv::BRISK::create(60, 3))  
-    , matcher_(cv::BFMatcher::create(cv::NORM_HAMMING, false))  // crossCheck=false for kNN
-    //, matcher_(cv::FlannBasedMatcher(cv::makePtr<cv::flann::LshIndexParams>(12, 20, 2)))
+    : brisk_(cv::BRISK::create(threshold_, octaves_))
 {
 }
 
-bool BriskDetector::init(const std::string& /*model_config*/,
+bool BriskDetector::init(const std::string& model_config,
                          const std::string& /*model_weights*/,
                          const std::string& reference_image)
 {
     std::cout << "[BriskDetector] Initializing with reference image: " 
               << reference_image << std::endl;
-    
-    // Load the reference image
-    reference_image_ = cv::imread(reference_image, cv::IMREAD_COLOR);
-    if (reference_image_.empty()) {
-        std::cerr << "[BriskDetector] ERROR: Could not load reference image: " 
-                  << reference_image << std::endl;
-        return false;
+
+    // Runtime options, e.g. "coarse_scale=0.5,refine_margin=2"
+    const ConfigString options(model_config);
+    coarse_scale_      = options.get_float("coarse_scale", coarse_scale_);
+    refine_margin_     = options.get_float("refine_margin", refine_margin_);
+    min_refine_radius_ = options.get_int("min_refine_radius", min_refine_radius_);
+    options.warn_unused("[BriskDetector]");
+    
+    // Reuse the cached reference model if the image and BRISK parameters
+    // are unchanged since it was written
+    ReferenceModel model;
+    const std::string params = "BRISK thresh=" + std::to_string(threshold_) +
+                               " octaves=" + std::to_string(octaves_);
+    if (use_reference_cache_ && load_reference_model(reference_image, "brisk", params, model)) {
+        std::cout << "[BriskDetector] Reference model loaded from "
+                  << reference_cache_path(reference_image, "brisk") << std::endl;
+    } else {
+        // Load the reference image
+        const cv::Mat reference_image_bgr = cv::imread(reference_image, cv::IMREAD_COLOR);
+        if (reference_image_bgr.empty()) {
+            std::cerr << "[BriskDetector] ERROR: Could not load reference image: "
+                      << reference_image << std::endl;
+            return false;
+        }
+
+        // Convert to grayscale
+        cv::Mat reference_gray;
+        cv::cvtColor(reference_image_bgr, reference_gray, cv::COLOR_BGR2GRAY);
+
+        // Detect keypoints and compute descriptors for reference image
+        brisk_->detectAndCompute(reference_gray, cv::noArray(),
+                                 model.keypoints, model.descriptors);
+        model.image_size = reference_image_bgr.size();
+
+        if (use_reference_cache_ && !model.keypoints.empty()) {
+            save_reference_model(reference_image, "brisk", params, model);
+        }
     }
-    
-    // Convert to grayscale
-    cv::cvtColor(reference_image_, reference_gray_, cv::COLOR_BGR2GRAY);
-    
-    // Detect keypoints and compute descriptors for reference image
-    brisk_->detectAndCompute(reference_gray_, cv::noArray(),
-                            reference_keypoints_, reference_descriptors_);
+
+    reference_size_        = model.image_size;
+    reference_keypoints_   = std::move(model.keypoints);
+    reference_descriptors_ = model.descriptors;
     
     if (reference_keypoints_.empty()) {
         std::cerr << "[BriskDetector] ERROR: No keypoints found in reference image" 
@@ -44,6 +73,13 @@ bool BriskDetector::init(const std::string& /*model_config*/,
               << " keypoints in reference image" << std::endl;
     std::cout << "[BriskDetector] Descriptor size: " 
               << reference_descriptors_.size() << std::endl;
+    reference_index_.clear();
+    if (reference_descriptors_.rows >= lsh_min_descriptors_ &&
+        !reference_index_.build(reference_descriptors_, lsh_params_)) {
+        std::cerr << "[BriskDetector] LSH index build failed - using brute-force matching"
+                  << std::endl;
+    }
+
     std::cout << "[BriskDetector] Initialization complete" << std::endl;
     
     return true;
@@ -65,61 +101,63 @@ DetectionResult BriskDetector::detect(RawFrame& frame)
         return result;
     }
     
-    // Convert frame to grayscale
-    cv::Mat frame_gray;
-    if (frame.data.channels() == 3) {
-        cv::cvtColor(frame.data, frame_gray, cv::COLOR_BGR2GRAY);
-    } else {
-        frame_gray = frame.data;
-    }
-    
-    // Resize for speed: toggle to enable/disable
-    constexpr bool USE_RESIZE = false;     // Set to false to disable resize
-    constexpr float SCALE = 0.5f;         // Resize scale (0.5 = 4x faster)
+    // Grayscale view of the frame (no conversion for I420/Gray input)
+    const cv::Mat& frame_gray = cached_gray(frame);
     
-    cv::Mat detection_frame;
+    // Full-resolution search area: the whole frame, or with coarse-to-fine
+    // only the neighbourhood of a hit on the downscaled frame
+    cv::Rect search_area(0, 0, frame_gray.cols, frame_gray.rows);
     std::vector<cv::KeyPoint> frame_keypoints;
     cv::Mat frame_descriptors;
-    
-    if (USE_RESIZE) {
-        // Detect on resized image
-        cv::resize(frame_gray, detection_frame, cv::Size(), SCALE, SCALE, cv::INTER_LINEAR);
-        brisk_->detectAndCompute(detection_frame, cv::noArray(),
-                                frame_keypoints, frame_descriptors);
-        
+    std::vector<cv::DMatch> good_matches;
+
+    if (coarse_scale_ > 0.f && coarse_scale_ < 1.f) {
+        cv::Mat coarse_frame;
+        cv::resize(frame_gray, coarse_frame, cv::Size(), coarse_scale_, coarse_scale_,
+                   cv::INTER_AREA);
+        brisk_->detectAndCompute(coarse_frame, cv::noArray(),
+                                 frame_keypoints, frame_descriptors);
+
         // Scale keypoint coordinates back to original resolution
         for (auto& kp : frame_keypoints) {
-            kp.pt.x /= SCALE;
-            kp.pt.y /= SCALE;
-            kp.size /= SCALE;
+            kp.pt.x /= coarse_scale_;
+            kp.pt.y /= coarse_scale_;
+            kp.size /= coarse_scale_;
         }
-    } else {
-        // Detect on full resolution
-        brisk_->detectAndCompute(frame_gray, cv::noArray(),
-                                frame_keypoints, frame_descriptors);
+
+        if (!match_frame(frame_descriptors, good_matches)) {
+            return result;
+        }
+
+        // Spread of the matched features approximates the object's extent
+        std::vector<cv::Point2f> matched;
+        matched.reserve(good_matches.size());
+        for (const auto& m : good_matches) {
+            matched.push_back(frame_keypoints[m.trainIdx].pt);
+        }
+        const cv::Point2f coarse_center = compute_center(frame_keypoints, good_matches);
+        const cv::Rect    extent        = cv::boundingRect(matched);
+        const float half_w = std::max(extent.width  * refine_margin_, static_cast<float>(min_refine_radius_));
+        const float half_h = std::max(extent.height * refine_margin_, static_cast<float>(min_refine_radius_));
+        search_area &= cv::Rect(cv::Point(cvRound(coarse_center.x - half_w), cvRound(coarse_center.y - half_h)),
+                                cv::Point(cvRound(coarse_center.x + half_w), cvRound(coarse_center.y + half_h)));
+        good_matches.clear();
     }
-    
+
+    // Detect on full resolution
+    brisk_->detectAndCompute(frame_gray(search_area), cv::noArray(),
+                             frame_keypoints, frame_descriptors);
+    const cv::Point2f offset(static_cast<float>(search_area.x), static_cast<float>(search_area.y));
+    for (auto& kp : frame_keypoints) {
+        kp.pt += offset;
+    }
+
     if (frame_keypoints.empty() || frame_descriptors.empty()) {
         // No keypoints found in frame
         return result;
     }
-    
-    // Match descriptors using KNN (k=2 for Lowe's ratio test)
-    std::vector<std::vector<cv::DMatch>> knn_matches;
-    try {
-        matcher_->knnMatch(reference_descriptors_, frame_descriptors, 
-                          knn_matches, 2);
-    } catch (const cv::Exception& e) {
-        std::cerr << "[BriskDetector] ERROR: Matching failed: " << e.what() << std::endl;
-        return result;
-    }
-    
-    // Apply Lowe's ratio test to filter good matches
-    std::vector<cv::DMatch> good_matches = filter_matches(knn_matches);
-    
-    // Check if we have enough good matches
-    if (good_matches.size() < static_cast<size_t>(min_good_matches_)) {
-        // Not enough matches for reliable detection
+
+    if (!match_frame(frame_descriptors, good_matches)) {
         return result;
     }
     
@@ -147,9 +185,8 @@ void BriskDetector::warmup()
     
     // Create a dummy frame for warm-up using reference image dimensions
     RawFrame dummy_frame;
-    if (!reference_image_.empty()) {
-        dummy_frame.data = cv::Mat(reference_image_.rows, reference_image_.cols, 
-                                   CV_8UC3, cv::Scalar(128, 128, 128));
+    if (!reference_size_.empty()) {
+        dummy_frame.data = cv::Mat(reference_size_, CV_8UC3, cv::Scalar(128, 128, 128));
     } else {
         // Fallback to a generic size if no reference loaded yet
         dummy_frame.data = cv::Mat(480, 640, CV_8UC3, cv::Scalar(128, 128, 128));
@@ -162,25 +199,37 @@ void BriskDetector::warmup()
     std::cout << "[BriskDetector] Warmup complete" << std::endl;
 }
 
-std::vector<cv::DMatch> BriskDetector::filter_matches(
-    const std::vector<std::vector<cv::DMatch>>& knn_matches) const
+bool BriskDetector::match_frame(const cv::Mat&            frame_descriptors,
+                                std::vector<cv::DMatch>& good_matches) const
 {
-    std::vector<cv::DMatch> good_matches;
-    
-    for (const auto& match_pair : knn_matches) {
-        // Lowe's ratio test requires at least 2 matches
-        if (match_pair.size() < 2) {
-            continue;
-        }
-        
-        // If the best match is significantly better than the second best,
-        // it's likely a good match
-        if (match_pair[0].distance < ratio_threshold_ * match_pair[1].distance) {
-            good_matches.push_back(match_pair[0]);
+    good_matches.clear();
+    if (frame_descriptors.empty()) {
+        return false;
+    }
+
+    // Match descriptors: best two frame features per reference feature,
+    // kept if they pass Lowe's ratio test
+    try {
+        if (!reference_index_.empty()) {
+            // The index answers frame → reference queries (the ratio test is
+            // per frame feature); flip to the reference → frame convention
+            // used below (trainIdx = frame keypoint).
+            reference_index_.ratio_match(frame_descriptors, ratio_threshold_, good_matches);
+            for (auto& m : good_matches) {
+                std::swap(m.queryIdx, m.trainIdx);
+            }
+        } else {
+            matcher_.ratio_match(reference_descriptors_, frame_descriptors,
+                                 ratio_threshold_, good_matches);
         }
+    } catch (const std::exception& e) {
+        std::cerr << "[BriskDetector] ERROR: Matching failed: " << e.what() << std::endl;
+        good_matches.clear();
+        return false;
     }
-    
-    return good_matches;
+
+    // Check if we have enough good matches for a reliable detection
+    return good_matches.size() >= static_cast<size_t>(min_good_matches_);
 }
 
 cv::Point2f BriskDetector::compute_center(
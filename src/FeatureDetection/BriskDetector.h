@@ -1,6 +1,8 @@
 #pragma once
 
 #include "interfaces.h"
+#include "Matching/HammingMatcher.h"
+#include "Matching/LshIndex.h"
 #include <opencv2/features2d.hpp>
 
 /**
@@ -9,7 +11,7 @@
  * This detector:
  * 1. Loads a reference image at initialization
  * 2. Detects BRISK keypoints and computes descriptors for both reference and incoming frames
- * 3. Matches features using BFMatcher with Hamming distance
+ * 3. Matches features using HammingMatcher (top-2 + Lowe's ratio test)
  * 4. Returns the center of the matched object region
  */
 class BriskDetector : public IFeatureDetector {
@@ -47,26 +49,48 @@ public:
 
 private:
     // BRISK feature detector and descriptor
+    // thresh = threshold (default 30, higher = fewer keypoints = faster)
+    // octaves = scale levels (default 3, lower = fewer scales = faster)
+    int threshold_ = 60;
+    int octaves_   = 3;
     cv::Ptr<cv::BRISK> brisk_;
     
-    // Reference image data
-    cv::Mat reference_image_;
-    cv::Mat reference_gray_;
+    // Reference model (keypoints/descriptors are cached on disk next to
+    // the image, see ReferenceModelCache, and reused across restarts)
+    cv::Size reference_size_;
+    bool use_reference_cache_ = true;
     std::vector<cv::KeyPoint> reference_keypoints_;
     cv::Mat reference_descriptors_;
     
     // Feature matcher (using Hamming distance for binary descriptors)
-    cv::Ptr<cv::BFMatcher> matcher_;
+    HammingMatcher matcher_;
+
+    // Approximate index over the reference descriptors, built at init()
+    // for large references (brute force is faster for small ones)
+    LshIndex  reference_index_;
+    LshParams lsh_params_;
+    int       lsh_min_descriptors_ = 2048;
     
     // Detection parameters
     int min_good_matches_ = 10;      // Minimum matches required for valid detection
     float ratio_threshold_ = 0.75f;   // Lowe's ratio test threshold
-    
+
+    // Coarse-to-fine: find the object on the frame scaled by coarse_scale_,
+    // then run full-resolution BRISK only within refine_margin_ x the
+    // spread of the coarse matches (at least min_refine_radius_ px around
+    // the coarse centre). 1 = off. Set via model_config, e.g.
+    // "coarse_scale=0.5,refine_margin=2,min_refine_radius=256".
+    float coarse_scale_ = 1.f;
+    float refine_margin_ = 1.5f;
+    int min_refine_radius_ = 256;
+
     /**
-     * @brief Apply Lowe's ratio test to filter good matches
+     * @brief Ratio-test matches of reference features against frame
+     *        descriptors (trainIdx = frame keypoint)
+     * @return true if at least min_good_matches_ survive
      */
-    std::vector<cv::DMatch> filter_matches(
-        const std::vector<std::vector<cv::DMatch>>& knn_matches) const;
+    bool match_frame(const cv::Mat& frame_descriptors,
+                     std::vector<cv::DMatch>& good_matches) const;
     
     /**
      * @brief Compute the center of matched keypoints
@@ -1,4 +1,5 @@
 #include "FeatureDetection/FastDetector.h"
+#include "Common/FrameCache.h"
 #include <opencv2/opencv.hpp>
 #include <iostream>
 #include <opencv2/features2d.hpp>
@@ -15,9 +16,8 @@ bool FastDetector::init(const std::string& /*model_config*/,
 
 DetectionResult FastDetector::detect(RawFrame& frame)
 {
-    // convert to grayscale
-    cv::Mat gray;
-    cv::cvtColor(frame.data, gray, cv::COLOR_BGR2GRAY);
+    // grayscale view (luma plane for I420/Gray input)
+    const cv::Mat& gray = cached_gray(frame);
 
     // run FAST
     auto fast = cv::FastFeatureDetector::create(
@@ -0,0 +1,256 @@
+#include "FeatureDetection/MultiRefDetector.h"
+#include "Common/ConfigString.h"
+#include "Common/FrameCache.h"
+#include "Common/ReferenceModelCache.h"
+
+#include <opencv2/calib3d.hpp>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+namespace fs = std::filesystem;
+
+namespace {
+
+bool is_image_file(const fs::path& p)
+{
+    std::string ext = p.extension().string();
+    std::transform(ext.begin(), ext.end(), ext.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return ext == ".png" || ext == ".jpg" || ext == ".jpeg" ||
+           ext == ".bmp" || ext == ".tif" || ext == ".tiff";
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Reference set
+// ─────────────────────────────────────────────────────────────────────────────
+
+std::vector<std::string> MultiRefDetector::expand_references(const std::string& spec)
+{
+    std::vector<std::string> paths;
+    std::stringstream ss(spec);
+    std::string entry;
+
+    while (std::getline(ss, entry, ';')) {
+        if (entry.empty()) continue;
+
+        std::error_code ec;
+        if (fs::is_directory(entry, ec)) {
+            std::vector<std::string> found;
+            for (const auto& e : fs::directory_iterator(entry, ec)) {
+                if (e.is_regular_file() && is_image_file(e.path())) {
+                    found.push_back(e.path().string());
+                }
+            }
+            std::sort(found.begin(), found.end());   // stable object ids
+            paths.insert(paths.end(), found.begin(), found.end());
+        } else {
+            paths.push_back(entry);
+        }
+    }
+    return paths;
+}
+
+bool MultiRefDetector::is_reference_set(const std::string& spec)
+{
+    std::error_code ec;
+    return spec.find(';') != std::string::npos || fs::is_directory(spec, ec);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// init
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool MultiRefDetector::init(const std::string& model_config,
+                            const std::string& /*model_weights*/,
+                            const std::string& reference_image)
+{
+    // Runtime options, e.g. "frame_features=4000,measurement_sigma=2"
+    const ConfigString options(model_config);
+    frame_features     = options.get_int("frame_features", frame_features);
+    reference_features = options.get_int("reference_features", reference_features);
+    acceleration_sigma = options.get_float("acceleration_sigma", acceleration_sigma);
+    measurement_sigma  = options.get_float("measurement_sigma", measurement_sigma);
+    options.warn_unused("[MultiRefDetector]");
+
+    if (frame_features <= 0 || reference_features <= 0) {
+        std::cerr << "[MultiRefDetector] frame_features and reference_features must be positive.\n";
+        return false;
+    }
+    if (acceleration_sigma <= 0.f || measurement_sigma <= 0.f) {
+        std::cerr << "[MultiRefDetector] acceleration_sigma and measurement_sigma must be positive.\n";
+        return false;
+    }
+
+    refs_.clear();
+    owner_.clear();
+    database_.release();
+    index_.clear();
+
+    frame_orb_ = cv::ORB::create(frame_features);
+    cv::Ptr<cv::ORB>  reference_orb = cv::ORB::create(reference_features);
+    const std::string params        = orb_params_key(reference_orb);
+
+    std::vector<cv::Mat> descriptor_blocks;
+    int                  cached = 0;
+    for (const std::string& path : expand_references(reference_image)) {
+        ReferenceModel model;
+        if (use_reference_cache && load_reference_model(path, "orb", params, model)) {
+            ++cached;
+        } else {
+            const cv::Mat image = cv::imread(path, cv::IMREAD_GRAYSCALE);
+            if (image.empty()) {
+                std::cerr << "[MultiRefDetector] Failed to load reference image: " << path << "\n";
+                return false;
+            }
+            reference_orb->detectAndCompute(image, cv::noArray(), model.keypoints, model.descriptors);
+            model.image_size = image.size();
+            if (use_reference_cache && !model.keypoints.empty()) {
+                save_reference_model(path, "orb", params, model);
+            }
+        }
+
+        const std::vector<cv::KeyPoint>& kps = model.keypoints;
+        if (kps.empty()) {
+            std::cerr << "[MultiRefDetector] No keypoints in reference image: " << path
+                      << " — skipped.\n";
+            continue;
+        }
+
+        Reference ref;
+        ref.name      = fs::path(path).stem().string();
+        ref.size      = model.image_size;
+        ref.first_row = static_cast<int>(owner_.size());
+        ref.motion.acceleration_sigma = acceleration_sigma;
+        ref.motion.measurement_sigma  = measurement_sigma;
+        ref.points.reserve(kps.size());
+        for (const auto& kp : kps) ref.points.push_back(kp.pt);
+
+        owner_.insert(owner_.end(), kps.size(), static_cast<int>(refs_.size()));
+        descriptor_blocks.push_back(model.descriptors);
+        refs_.push_back(std::move(ref));
+    }
+
+    if (refs_.empty()) {
+        std::cerr << "[MultiRefDetector] No usable reference images in: " << reference_image << "\n";
+        return false;
+    }
+    cv::vconcat(descriptor_blocks, database_);
+
+    if (database_.rows >= lsh_min_descriptors && !index_.build(database_, lsh_params)) {
+        std::cerr << "[MultiRefDetector] LSH index build failed — using brute-force matching.\n";
+    }
+
+    std::cout << "[MultiRefDetector] " << refs_.size() << " references, "
+              << database_.rows << " descriptors ("
+              << (index_.empty() ? "brute force" : "LSH index") << ", "
+              << cached << " from reference cache)\n";
+    for (std::size_t i = 0; i < refs_.size(); ++i) {
+        std::cout << "  [" << i << "] " << refs_[i].name << "  "
+                  << refs_[i].points.size() << " keypoints\n";
+    }
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// detect
+// ─────────────────────────────────────────────────────────────────────────────
+
+DetectionResult MultiRefDetector::detect(RawFrame& frame)
+{
+    const std::vector<ObjectDetection> all = detect_all(frame);
+
+    if (primary_object >= 0) {
+        return primary_object < static_cast<int>(all.size())
+                   ? all[primary_object].result
+                   : DetectionResult{};
+    }
+
+    DetectionResult best;
+    for (const auto& obj : all) {
+        if (obj.result.valid && (!best.valid || obj.result.confidence > best.confidence)) {
+            best = obj.result;
+        }
+    }
+    return best;
+}
+
+std::vector<ObjectDetection> MultiRefDetector::detect_all(RawFrame& frame)
+{
+    std::vector<ObjectDetection> out(refs_.size());
+    for (std::size_t i = 0; i < refs_.size(); ++i) {
+        out[i].object_id = static_cast<int>(i);
+        out[i].name      = refs_[i].name;
+    }
+    if (refs_.empty() || frame.data.empty()) return out;
+
+    for (Reference& ref : refs_) ref.motion.predict(frame.pts_ns);
+
+    // ── Frame features, once for all objects ─────────────────────────────────
+    const cv::Mat& gray  = cached_gray(frame);
+    FrameCache&    cache = frame.cache;
+    if (!cache.features_computed) {
+        extractor_.detect_and_compute(frame_orb_, gray, cache.keypoints, cache.descriptors);
+        cache.features_computed = true;
+    }
+    if (cache.descriptors.empty()) return out;
+
+    // ── One cross-checked match against the whole database ──────────────────
+    std::vector<cv::DMatch> matches;
+    if (!index_.empty()) {
+        index_.match(cache.descriptors, matches);
+    } else {
+        matcher_.match(cache.descriptors, database_, matches);
+    }
+
+    // ── Assign matches to their objects ──────────────────────────────────────
+    std::vector<std::vector<cv::Point2f>> frame_pts(refs_.size());
+    std::vector<std::vector<cv::Point2f>> ref_pts(refs_.size());
+    std::vector<std::vector<float>>       distances(refs_.size());   // PROSAC ordering
+    for (const auto& m : matches) {
+        if (m.distance >= max_distance) continue;
+        const int obj = owner_[m.trainIdx];
+        frame_pts[obj].push_back(cache.keypoints[m.queryIdx].pt);
+        ref_pts[obj].push_back(refs_[obj].points[m.trainIdx - refs_[obj].first_row]);
+        distances[obj].push_back(m.distance);
+    }
+
+    // ── Geometric verification per object ────────────────────────────────────
+    for (std::size_t i = 0; i < refs_.size(); ++i) {
+        if (static_cast<int>(frame_pts[i].size()) < min_inliers) continue;
+        Reference& ref = refs_[i];
+
+        cv::Matx33d H;
+        if (!estimator_.estimate(ref_pts[i], frame_pts[i], distances[i], H)) continue;
+
+        const int inliers = estimator_.last_inliers();
+        if (inliers < min_inliers) continue;
+
+        const float rw = static_cast<float>(ref.size.width);
+        const float rh = static_cast<float>(ref.size.height);
+        const std::vector<cv::Point2f> corners = {
+            { rw / 2.f, rh / 2.f }, { 0.f, 0.f }, { rw, 0.f }, { rw, rh }, { 0.f, rh } };
+        std::vector<cv::Point2f> projected;
+        cv::perspectiveTransform(corners, projected, H);
+
+        const cv::Point2f centre = projected[0];
+        if (centre.x < 0 || centre.y < 0 || centre.x >= gray.cols || centre.y >= gray.rows) {
+            continue;
+        }
+
+        out[i].bounds            = cv::boundingRect(
+            std::vector<cv::Point2f>(projected.begin() + 1, projected.end()));
+        out[i].result.center     = ref.motion.correct(centre);
+        out[i].result.confidence = static_cast<float>(inliers) /
+                                   static_cast<float>(frame_pts[i].size());
+        out[i].result.valid      = true;
+    }
+    return out;
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#include "interfaces.h"
+#include "Common/MotionFilter.h"
+#include "FeatureDetection/TiledOrbExtractor.h"
+#include "Geometry/RobustEstimator.h"
+#include "Matching/HammingMatcher.h"
+#include "Matching/LshIndex.h"
+
+#include <opencv2/features2d.hpp>
+
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// MultiRefDetector
+//
+// Locates several reference objects per frame with one feature pass.
+//
+//   reference_image = "runway.png;hangar.png"     (';'-separated list)
+//                   = "refs/"                     (every image in the folder)
+//
+// Design:
+//   - All reference descriptors live in one database Mat with an owner
+//     (object id) per row; it is indexed once at init() (LshIndex when large)
+//   - Each frame: ORB once (shared through the frame cache), one
+//     cross-checked match against the whole database — so every frame
+//     feature is assigned to at most one object — then a RANSAC homography
+//     only for objects that collected enough matches
+//   - Cost is dominated by frame feature extraction and a sub-linear
+//     database query, so it grows little with the number of references
+//   - Per-reference keypoints/descriptors are kept in an on-disk cache
+//     (ReferenceModelCache), so restarts skip reference extraction
+//   - detect() reports the primary object (most confident, or the one
+//     selected by primary_object) for the single-object pipeline;
+//     detect_all() reports every object
+// ─────────────────────────────────────────────────────────────────────────────
+
+class MultiRefDetector : public IMultiObjectDetector {
+public:
+    int       frame_features      = 2000;   // ORB features per frame (all objects)
+    int       reference_features  = 500;    // ORB features per reference image
+    float     max_distance        = 60.f;   // Hamming, 0–256
+    int       min_inliers         = 8;
+    float     acceleration_sigma  = 400.f;  // per-object MotionFilter, px/s²
+    float     measurement_sigma   = 3.f;    // px
+    int       primary_object      = -1;     // detect() result; -1 = most confident
+    int       lsh_min_descriptors = 2048;   // database size from which LSH is used
+    bool      use_reference_cache = true;   // <image>.orb.refmodel per reference
+    LshParams lsh_params;
+
+    // model_config may override frame_features, reference_features,
+    // acceleration_sigma and measurement_sigma, e.g. "frame_features=4000".
+    bool init(const std::string& model_config,
+              const std::string& model_weights,
+              const std::string& reference_image) override;
+
+    DetectionResult              detect(RawFrame& frame) override;
+    std::vector<ObjectDetection> detect_all(RawFrame& frame) override;
+    std::size_t                  object_count() const override { return refs_.size(); }
+
+    // Frame ORB model, to share with a stabilizer (valid after init()).
+    cv::Ptr<cv::ORB> orb_model() const { return frame_orb_; }
+
+    // Split a reference spec into image paths (list entries and folders).
+    static std::vector<std::string> expand_references(const std::string& spec);
+
+    // True if `spec` names more than a single image file.
+    static bool is_reference_set(const std::string& spec);
+
+private:
+    struct Reference {
+        std::string              name;
+        cv::Size                 size;
+        std::vector<cv::Point2f> points;         // keypoint per database row
+        int                      first_row = 0;  // into database_
+
+        MotionFilter             motion;         // filtered centre
+    };
+
+    cv::Ptr<cv::ORB>       frame_orb_;
+    TiledOrbExtractor      extractor_;           // frame_orb_, tile-parallel
+    std::vector<Reference> refs_;
+    cv::Mat                database_;            // all reference descriptors
+    std::vector<int>       owner_;               // object id per database row
+
+    HammingMatcher         matcher_;
+    LshIndex               index_;
+    RobustEstimator        estimator_;           // PROSAC homography per object
+};
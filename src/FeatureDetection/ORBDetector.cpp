@@ -1,12 +1,27 @@
 #include "FeatureDetection/ORBDetector.h"
+#include "Common/ConfigString.h"
+#include "Common/FrameCache.h"
+#include "Common/ReferenceModelCache.h"
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include <vector>
 using namespace std;
 
-bool ORBDetector::init(const std::string&, const std::string&,
+bool ORBDetector::init(const std::string& model_config, const std::string&,
                        const std::string& reference_image)
 {
     std::cout << "[ORBDetector] init()\n";
+
+    // Runtime options, e.g. "coarse_scale=0.25,refine_margin=2"
+    const ConfigString options(model_config);
+    coarseScale     = options.get_float("coarse_scale", coarseScale);
+    refineMargin    = options.get_float("refine_margin", refineMargin);
+    useSearchWindow = options.get_bool("search_window", useSearchWindow);
+    options.warn_unused("[ORBDetector]");
+    if (coarseScale < 1.f)
+        std::cout << "[ORBDetector] Coarse-to-fine: localise at " << coarseScale
+                  << "x, refine within " << refineMargin << "x the object extent\n";
     // nfeatures    - 400
     // scale factor (ratio the image is divided by between scale in the pyramid of gaussians) - default: 1.2f
     // nlevels (n of pyramid levels) - default 8
@@ -14,21 +29,47 @@ bool ORBDetector::init(const std::string&, const std::string&,
     ModelORB = ORB::create(400);
     reference_image_path = reference_image;
 
-    // Load and compute reference descriptors ONCE here, not every frame
-    Mat objectMat = cv::imread(reference_image_path);
-    if (objectMat.empty()) {
-        std::cerr << "[ORBDetector] Failed to load reference image: " << reference_image_path << "\n";
-        return false;
+    // Reference model from the on-disk cache when it matches the image and
+    // ORB parameters; otherwise decode, describe and refresh the cache.
+    ReferenceModel model;
+    const std::string params = orb_params_key(ModelORB);
+    if (useReferenceCache && load_reference_model(reference_image_path, "orb", params, model)) {
+        std::cout << "[ORBDetector] Reference model loaded from "
+                  << reference_cache_path(reference_image_path, "orb") << "\n";
+    } else {
+        // Load and compute reference descriptors ONCE here, not every frame
+        Mat objectMat = cv::imread(reference_image_path);
+        if (objectMat.empty()) {
+            std::cerr << "[ORBDetector] Failed to load reference image: " << reference_image_path << "\n";
+            return false;
+        }
+        cvtColor(objectMat, objectMatGray, COLOR_BGR2GRAY);
+        ModelORB->detectAndCompute(objectMatGray, Mat(), model.keypoints, model.descriptors);
+        model.image_size = objectMat.size();
+
+        if (useReferenceCache && !model.keypoints.empty())
+            save_reference_model(reference_image_path, "orb", params, model);
     }
-    cvtColor(objectMat, objectMatGray, COLOR_BGR2GRAY);
-    ModelORB->detectAndCompute(objectMatGray, Mat(), keypointsObject, descriptorsObject);
+
+    keypointsObject   = std::move(model.keypoints);
+    descriptorsObject = model.descriptors;
+    referenceSize     = model.image_size;
+    KeyPoint::convert(keypointsObject, pointsObject);
 
     if (keypointsObject.empty()) {
         std::cerr << "[ORBDetector] No keypoints found in reference image.\n";
         return false;
     }
 
-    referenceSize = objectMat.size();
+    motionFilter.reset();
+    searchMisses = 0;
+    lastHomography.release();
+
+    referenceIndex.clear();
+    if (descriptorsObject.rows >= lshMinDescriptors &&
+        !referenceIndex.build(descriptorsObject, lshParams)) {
+        std::cerr << "[ORBDetector] LSH index build failed — using brute-force matching.\n";
+    }
     return true;
 }
 
@@ -37,79 +78,311 @@ DetectionResult ORBDetector::detect(RawFrame& frame)
     DetectionResult r;
     r.valid = false;
 
-    Mat gray_frame;
-    cvtColor(frame.data, gray_frame, COLOR_BGR2GRAY);
+    // Y plane view for I420/Gray input, converted only for BGR
+    const Mat& gray_frame = cached_gray(frame);
+
+    // Advance the motion model to this frame before placing the window
+    motionFilter.predict(frame.pts_ns);
+
+    // Search only around the predicted position when we have one
+    Rect window = searchWindow(gray_frame.size());
+
+    // Any early return below is a miss. A fresh track reports its
+    // prediction; a lost one is dropped so the next hit starts over.
+    searchMisses = std::min(searchMisses + 1, maxSearchMisses + 1);
+    auto miss = [&]() {
+        if (searchMisses > maxSearchMisses) {
+            motionFilter.reset();
+        } else if (reportPredictions && motionFilter.initialized()) {
+            r.center    = motionFilter.position();
+            r.valid     = true;
+            r.predicted = true;
+        }
+        return r;
+    };
+
+    if (keypointsObject.empty()) return miss();
+
+    // Coarse-to-fine: nothing to search around, so find the object on a
+    // downscaled frame first and refine only around that hit
+    if (window.area() == 0 && coarseScale > 0.f && coarseScale < 1.f) {
+        vector<KeyPoint> coarseKeypoints;
+        Mat coarseDescriptors;
+        extractor.detect_and_compute(ModelORB, coarseImage(frame, coarseScale),
+                                     coarseKeypoints, coarseDescriptors);
+
+        const float toFull = 1.f / coarseScale;
+        for (auto& kp : coarseKeypoints) {
+            kp.pt   *= toFull;
+            kp.size *= toFull;
+        }
+
+        Point2f coarseCenter;
+        Rect    coarseOutline;
+        float   coarseConfidence = 0.f;
+        Mat     coarseHomography;
+        if (!locate(coarseKeypoints, coarseDescriptors, Mat(), coarseCenter, coarseOutline,
+                    coarseConfidence, coarseHomography))
+            return miss();
+
+        window = windowAround(coarseCenter, coarseOutline.size(), refineMargin, 0.f, gray_frame.size());
+    }
+    const bool roiSearch = window.area() > 0;
+
+    FrameCache& cache = frame.cache;
+    vector<KeyPoint> roiKeypoints;
+    Mat roiDescriptors;
+
+    if (roiSearch) {
+        extractor.detect_and_compute(ModelORB, gray_frame(window), roiKeypoints, roiDescriptors);
 
-    ModelORB->detectAndCompute(gray_frame, Mat(), frame.keypoints, frame.descriptors);
-    
-    //Cache keypoints and descriptors for use in stabilization
-    frame.features_computed = true;
+        // Back to source coordinates. These are not full-frame features, so
+        // they are not published to the frame cache for the stabilizer.
+        const Point2f offset(static_cast<float>(window.x), static_cast<float>(window.y));
+        for (auto& kp : roiKeypoints) kp.pt += offset;
+    } else if (!cache.features_computed) {
+        //Cache keypoints and descriptors for use in stabilization
+        extractor.detect_and_compute(ModelORB, gray_frame, cache.keypoints, cache.descriptors);
+        cache.features_computed = true;
+    }
+
+    const vector<KeyPoint>& frameKeypoints   = roiSearch ? roiKeypoints   : cache.keypoints;
+    const Mat&              frameDescriptors = roiSearch ? roiDescriptors : cache.descriptors;
+
+    Point2f detectedCenter;
+    Rect    outline;
+    float   confidence = 0.f;
+    Mat     homography;
+    if (!locate(frameKeypoints, frameDescriptors, predictedHomography(), detectedCenter,
+                outline, confidence, homography))
+        return miss();
 
-    if (frame.descriptors.empty() || keypointsObject.empty()) return r;
+    // Sanity check: projected center should be within the frame bounds
+    if (detectedCenter.x < 0 || detectedCenter.y < 0 ||
+        detectedCenter.x >= gray_frame.cols ||
+        detectedCenter.y >= gray_frame.rows)
+        return miss();
 
-    // Match frame descriptors against the pre-computed reference descriptors
-    BFMatcher bruteforceMatcher(cv::NORM_HAMMING, true);
-    vector<DMatch> matches;
-    bruteforceMatcher.match(frame.descriptors, descriptorsObject, matches);
+    lastObjectRect = outline;
+    searchMisses   = 0;
 
-    if (matches.empty()) return r;
+    // Filter the center to reduce frame-to-frame jitter (no lag for a
+    // target moving at constant speed, unlike a plain EMA)
+    const Point2f filteredCenter = motionFilter.correct(detectedCenter);
+    lastHomography     = homography;
+    lastFilteredCenter = filteredCenter;
+
+    r.center     = filteredCenter;
+    r.confidence = confidence;
+    r.valid      = true;
+    return r;
+}
+
+bool ORBDetector::locate(const vector<KeyPoint>& frameKeypoints, const Mat& frameDescriptors,
+                         const Mat& prior, Point2f& center, Rect& outline, float& confidence,
+                         Mat& homography)
+{
+    if (frameDescriptors.empty()) return false;
 
-    // Filter by absolute Hamming distance threshold (more reliable than relative formula)
-    // ORB distances range 0-256; good matches are typically < 60-80
-    const float DISTANCE_THRESHOLD = 60.f;
     const int MIN_GOOD_MATCHES = 8; // Require a meaningful number of inliers
 
-    vector<DMatch> goodMatches;
-    for (const auto& m : matches)
-        if (m.distance < DISTANCE_THRESHOLD)
-            goodMatches.push_back(m);
+    // Guided: match each reference keypoint only against frame keypoints
+    // around its projection through the prior
+    vector<DMatch>  goodMatches;
+    vector<Point2f> predicted;
+    if (!prior.empty()) {
+        perspectiveTransform(pointsObject, predicted, prior);
+        const float radius = std::min(guidedRadius + motionFilter.uncertainty_radius(1.f),
+                                      guidedMaxRadius);
+        guidedMatcher.match(frameKeypoints, frameDescriptors, descriptorsObject, predicted,
+                            radius, goodMatches);
+        if ((int)goodMatches.size() < guidedMinMatches) goodMatches.clear();
+    }
+    const bool guided = !goodMatches.empty();
+
+    if (!guided) {
+        // Match frame descriptors against the pre-computed reference descriptors
+        // (cross-checked: only mutual nearest neighbours survive)
+        vector<DMatch> matches;
+        if (!referenceIndex.empty())
+            referenceIndex.match(frameDescriptors, matches);
+        else
+            matcher.match(frameDescriptors, descriptorsObject, matches);
+
+        if (matches.empty()) return false;
+
+        // Filter by absolute Hamming distance threshold (more reliable than relative formula)
+        // ORB distances range 0-256; good matches are typically < 60-80
+        const float DISTANCE_THRESHOLD = 60.f;
+
+        for (const auto& m : matches)
+            if (m.distance < DISTANCE_THRESHOLD)
+                goodMatches.push_back(m);
+    }
 
-    if ((int)goodMatches.size() < MIN_GOOD_MATCHES) return r;
+    if ((int)goodMatches.size() < MIN_GOOD_MATCHES) return false;
 
     // --- Geometric verification with homography ---
     // This is the key step that eliminates false positives.
     // A valid detection should have keypoints consistent with a planar transform.
-    vector<Point2f> ptsFrame, ptsObject;
+    vector<Point2f> ptsFrame, ptsObject, ptsPredicted;
+    vector<float>   distances;       // PROSAC ordering
     for (const auto& m : goodMatches) {
-        ptsFrame.push_back(frame.keypoints[m.queryIdx].pt);
-        ptsObject.push_back(keypointsObject[m.trainIdx].pt);
+        ptsFrame.push_back(frameKeypoints[m.queryIdx].pt);
+        ptsObject.push_back(pointsObject[m.trainIdx]);
+        distances.push_back(m.distance);
+        if (guided) ptsPredicted.push_back(predicted[m.trainIdx]);
     }
 
-    Mat inlierMask;
-    Mat H = findHomography(ptsObject, ptsFrame, RANSAC, 3.0, inlierMask);
+    const double REPROJECTION_THRESHOLD = 3.0;
+    homographyEstimator.params.model     = MotionModel::Homography;
+    homographyEstimator.params.threshold = REPROJECTION_THRESHOLD;
 
-    if (H.empty()) return r;
+    vector<uchar> inlierMask;
+    Mat H;
+    if (guided)
+        H = fitFromPrior(ptsObject, ptsFrame, ptsPredicted, REPROJECTION_THRESHOLD, inlierMask);
+    if (H.empty()) {
+        Matx33d estimated;
+        if (!homographyEstimator.estimate(ptsObject, ptsFrame, distances, estimated, &inlierMask))
+            return false;
+        H = Mat(estimated);
+    }
 
     // Count inliers and reject if too few survive RANSAC
     int inlierCount = countNonZero(inlierMask);
-    if (inlierCount < MIN_GOOD_MATCHES) return r;
+    if (inlierCount < MIN_GOOD_MATCHES) return false;
 
     // Project the center of the reference image through the homography
     // This gives a stable, geometry-consistent center rather than a keypoint average
-    Point2f refCenter(referenceSize.width / 2.f, referenceSize.height / 2.f);
-    vector<Point2f> refPts = { refCenter };
+    // The projected corners give the object's extent for the next search window
+    const float rw = static_cast<float>(referenceSize.width);
+    const float rh = static_cast<float>(referenceSize.height);
+    Point2f refCenter(rw / 2.f, rh / 2.f);
+    vector<Point2f> refPts = { refCenter, { 0.f, 0.f }, { rw, 0.f }, { rw, rh }, { 0.f, rh } };
     vector<Point2f> projectedPts;
     perspectiveTransform(refPts, projectedPts, H);
 
-    // Sanity check: projected center should be within the frame bounds
-    Point2f detectedCenter = projectedPts[0];
-    if (detectedCenter.x < 0 || detectedCenter.y < 0 ||
-        detectedCenter.x >= gray_frame.cols ||
-        detectedCenter.y >= gray_frame.rows)
-        return r;
+    center     = projectedPts[0];
+    outline    = boundingRect(vector<Point2f>(projectedPts.begin() + 1, projectedPts.end()));
+    // Confidence based on inlier ratio
+    confidence = (float)inlierCount / (float)goodMatches.size();
+    homography = H;
+    return true;
+}
 
-    // Smooth the center over time to reduce frame-to-frame jitter
-    const float ALPHA = 0.4f; // lower = smoother but more lag
-    if (!lastValid) {
-        smoothedCenter = detectedCenter;
-        lastValid = true;
-    } else {
-        smoothedCenter = ALPHA * detectedCenter + (1.f - ALPHA) * smoothedCenter;
+Mat ORBDetector::predictedHomography() const
+{
+    // Only right after a hit (detect() has already counted this frame)
+    if (!useGuidedMatching || lastHomography.empty() || searchMisses != 1 ||
+        !motionFilter.initialized())
+        return Mat();
+
+    const Point2f shift = motionFilter.position() - lastFilteredCenter;
+    const Mat T = (Mat_<double>(3, 3) << 1, 0, shift.x,
+                                         0, 1, shift.y,
+                                         0, 0, 1);
+    return T * lastHomography;
+}
+
+Mat ORBDetector::fitFromPrior(const vector<Point2f>& ptsObject, const vector<Point2f>& ptsFrame,
+                              const vector<Point2f>& ptsPredicted, double threshold,
+                              vector<uchar>& inlierMask)
+{
+    const int n = static_cast<int>(ptsFrame.size());
+
+    // Remaining shift of the prediction: median residual, robust to the
+    // outliers still among the guided matches
+    vector<float> dx(n), dy(n);
+    for (int i = 0; i < n; ++i) {
+        dx[i] = ptsFrame[i].x - ptsPredicted[i].x;
+        dy[i] = ptsFrame[i].y - ptsPredicted[i].y;
     }
+    std::nth_element(dx.begin(), dx.begin() + n / 2, dx.end());
+    std::nth_element(dy.begin(), dy.begin() + n / 2, dy.end());
+    const Point2f shift(dx[n / 2], dy[n / 2]);
 
-    // Confidence based on inlier ratio
-    r.center     = smoothedCenter;
-    r.confidence = (float)inlierCount / (float)goodMatches.size();
-    r.valid      = true;
-    return r;
-}
\ No newline at end of file
+    // Matches consistent with the shifted prediction seed a least-squares fit
+    const float seedThreshold = priorSeedThreshold * priorSeedThreshold;
+    vector<Point2f> seedObject, seedFrame;
+    for (int i = 0; i < n; ++i) {
+        const Point2f d = ptsFrame[i] - (ptsPredicted[i] + shift);
+        if (d.dot(d) <= seedThreshold) {
+            seedObject.push_back(ptsObject[i]);
+            seedFrame.push_back(ptsFrame[i]);
+        }
+    }
+    if ((int)seedObject.size() < guidedMinMatches) return Mat();
+
+    // Two least-squares passes, each over the previous fit's inliers
+    Matx33d H;
+    if (!homographyEstimator.fit(seedObject, seedFrame, H)) return Mat();
+    for (int pass = 0; pass < 2; ++pass) {
+        vector<Point2f> projected;
+        perspectiveTransform(ptsObject, projected, H);
+
+        inlierMask.assign(n, 0);
+        seedObject.clear();
+        seedFrame.clear();
+        for (int i = 0; i < n; ++i) {
+            const Point2f d = ptsFrame[i] - projected[i];
+            if (d.dot(d) <= threshold * threshold) {
+                inlierMask[i] = 1;
+                seedObject.push_back(ptsObject[i]);
+                seedFrame.push_back(ptsFrame[i]);
+            }
+        }
+        // Not clearly consistent: leave it to RANSAC
+        if ((int)seedObject.size() < guidedMinMatches ||
+            (float)seedObject.size() < priorMinInlierRatio * n)
+            return Mat();
+        if (pass == 0 && !homographyEstimator.fit(seedObject, seedFrame, H)) return Mat();
+    }
+    return Mat(H);
+}
+
+Mat ORBDetector::coarseImage(const RawFrame& frame, float scale)
+{
+    // Power-of-two scales come straight from the shared frame pyramid
+    int   level      = 0;
+    float levelScale = 1.f;
+    while (levelScale * 0.5f >= scale * 0.999f) {
+        levelScale *= 0.5f;
+        ++level;
+    }
+    if (std::abs(levelScale - scale) <= scale * 1e-3f)
+        return cached_pyramid(frame, level + 1)[level];
+
+    Mat small;
+    resize(cached_gray(frame), small, Size(), scale, scale, INTER_AREA);
+    return small;
+}
+
+Rect ORBDetector::searchWindow(Size frameSize) const
+{
+    // No position to search around yet, or lost for too long: full frame
+    if (!useSearchWindow || !motionFilter.initialized() || searchMisses > maxSearchMisses)
+        return Rect();
+
+    // Object extent plus the position uncertainty, which the filter grows
+    // on every miss
+    return windowAround(motionFilter.position(), lastObjectRect.size(), searchMargin,
+                        motionFilter.uncertainty_radius(searchSigmas), frameSize);
+}
+
+Rect ORBDetector::windowAround(Point2f center, Size extent, float margin, float radius,
+                               Size frameSize) const
+{
+    const float halfW = std::max(extent.width  * margin + radius, (float)minSearchRadius);
+    const float halfH = std::max(extent.height * margin + radius, (float)minSearchRadius);
+
+    const Rect frameRect(Point(0, 0), frameSize);
+    const Rect window = Rect(Point(cvRound(center.x - halfW), cvRound(center.y - halfH)),
+                             Point(cvRound(center.x + halfW), cvRound(center.y + halfH)))
+                        & frameRect;
+
+    // Covering (almost) everything anyway — skip the ROI bookkeeping
+    if (window.area() >= frameRect.area() * 3 / 4)
+        return Rect();
+    return window;
+}
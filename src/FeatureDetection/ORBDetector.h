@@ -1,6 +1,12 @@
 #pragma once
 
 #include "interfaces.h"
+#include "Common/MotionFilter.h"
+#include "FeatureDetection/TiledOrbExtractor.h"
+#include "Geometry/RobustEstimator.h"
+#include "Matching/GuidedMatcher.h"
+#include "Matching/HammingMatcher.h"
+#include "Matching/LshIndex.h"
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 #include <iostream>
@@ -17,12 +23,109 @@ public:
               const std::string&) override;
 
     DetectionResult detect(RawFrame& frame) override;
+
+    // Search window around the last detected object; empty rect = full frame.
+    Rect searchWindow(Size frameSize) const;
+
+    // Window of `margin` x `extent` plus `radius` around `center` (at least
+    // minSearchRadius); empty rect if it would cover most of the frame.
+    Rect windowAround(Point2f center, Size extent, float margin, float radius,
+                      Size frameSize) const;
+
+    // Match frame features against the reference and verify them with a
+    // homography. Returns the projected centre, the reference outline, the
+    // inlier ratio and the homography (reference → source px). With a
+    // `prior` homography, matching is guided by it (see useGuidedMatching).
+    bool locate(const vector<KeyPoint>& frameKeypoints, const Mat& frameDescriptors,
+                const Mat& prior, Point2f& center, Rect& outline, float& confidence,
+                Mat& homography);
+
+    // Last hit's homography moved by the filter's predicted displacement
+    // since then; empty when the previous frame was not a hit.
+    Mat predictedHomography() const;
+
+    // Homography from guided matches without RANSAC: shift the prediction
+    // by the median residual, least-squares fit the matches it explains,
+    // refit on that fit's inliers. Empty if the inlier set is too small.
+    Mat fitFromPrior(const vector<Point2f>& ptsObject, const vector<Point2f>& ptsFrame,
+                     const vector<Point2f>& ptsPredicted, double threshold,
+                     vector<uchar>& inlierMask);
+
+    // Gray frame scaled by `scale` (from the frame pyramid for powers of two).
+    static Mat coarseImage(const RawFrame& frame, float scale);
+
     Ptr<ORB> ModelORB;
     std::string reference_image_path;
-    Mat objectMatGray;
+    Mat objectMatGray;               // empty when loaded from the reference cache
     vector<KeyPoint> keypointsObject;
+    vector<Point2f> pointsObject;    // keypointsObject positions
     Mat descriptorsObject;
+    HammingMatcher matcher;
+
+    // Homography fitting: PROSAC over the matches ordered by Hamming
+    // distance, and the least-squares fits of guided matching
+    RobustEstimator homographyEstimator;
+
+    // Frame features are extracted tile-parallel with ModelORB's
+    // parameters (reference features use ModelORB directly)
+    TiledOrbExtractor extractor;
+
+    // Approximate index over the reference descriptors, built at init() when
+    // there are at least lshMinDescriptors of them (brute force is faster
+    // below that). Set lshParams before init() to trade recall for speed.
+    LshIndex  referenceIndex;
+    LshParams lshParams;
+    int       lshMinDescriptors = 2048;
     cv::Size referenceSize;
-    Point2f smoothedCenter;
-    bool lastValid = false;
+
+    // Keypoints/descriptors are cached next to the reference image
+    // (<image>.orb.refmodel) and reused while the image and ORB parameters
+    // are unchanged, so restarts skip reference extraction.
+    bool useReferenceCache = true;
+
+    // Constant-velocity Kalman filter over the detected centre: smooths
+    // detections, predicts the centre on misses and sizes the search window.
+    MotionFilter motionFilter;
+
+    // On a miss, report the predicted centre (DetectionResult::predicted)
+    // for up to maxSearchMisses frames instead of an invalid result.
+    bool reportPredictions = true;
+
+    // ROI search: run ORB only around the predicted object position. The
+    // window covers the object extent plus searchSigmas standard deviations
+    // of the filter's position uncertainty, which grows by itself on misses;
+    // after maxSearchMisses misses in a row the full frame is searched again.
+    bool  useSearchWindow  = true;
+    float searchMargin     = 1.5f;   // object part of the window = extent * margin
+    int   minSearchRadius  = 256;    // px, lower bound on the window half-size
+    float searchSigmas     = 3.f;
+    int   maxSearchMisses  = 3;
+
+    // Coarse-to-fine: when there is no search window (start-up, lost
+    // track) locate the object on the frame scaled by coarseScale, then
+    // extract full-resolution features only in a window of refineMargin x
+    // the coarse object extent. 1 = off (full-frame extraction).
+    // Set via model_config: "coarse_scale=0.25,refine_margin=1.5".
+    float coarseScale      = 1.f;
+    float refineMargin     = 1.5f;
+
+    // Guided matching: after a hit, reference keypoints are projected
+    // through predictedHomography() and matched only against frame
+    // keypoints within guidedRadius (+ the filter's 1-sigma uncertainty,
+    // capped at guidedMaxRadius) of their projection. The homography is
+    // then fitted from the prior (median residual shift + least squares)
+    // and RANSAC only runs if that fit is not consistent. Falls back to
+    // global matching below guidedMinMatches matches.
+    bool          useGuidedMatching = true;
+    GuidedMatcher guidedMatcher;
+    float         guidedRadius      = 24.f;   // px
+    float         guidedMaxRadius   = 96.f;
+    int           guidedMinMatches  = 20;
+    float         priorSeedThreshold  = 8.f;    // px, residual after the median shift
+    float         priorMinInlierRatio = 0.6f;   // below this RANSAC runs instead
+
+    Rect  lastObjectRect;            // projected reference outline, source px
+    Mat     lastHomography;          // reference → source px at the last hit
+    Point2f lastFilteredCenter;      // filter position right after that hit
+    int   searchMisses     = 0;
 };
\ No newline at end of file
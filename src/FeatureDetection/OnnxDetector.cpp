@@ -0,0 +1,261 @@
+#include "FeatureDetection/OnnxDetector.h"
+#include "Common/ConfigString.h"
+#include "Common/ImageOps.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+// Tile origins along one axis: `extent` wide tiles every `stride` pixels,
+// the last one flush with the far edge.
+std::vector<int> tile_origins(int length, int extent, int stride)
+{
+    std::vector<int> origins;
+    for (int pos = 0;; pos += stride) {
+        if (pos + extent >= length) {
+            origins.push_back(std::max(0, (length - extent) & ~1));
+            break;
+        }
+        origins.push_back(pos);
+    }
+    return origins;
+}
+
+} // namespace
+
+bool OnnxDetector::init(const std::string& model_config,
+                        const std::string& model_weights,
+                        const std::string& /*reference_image*/)
+{
+    // Runtime options, e.g. "input_scale=0.25,class_id=0"
+    const ConfigString options(model_config);
+    input_size      = options.get_int("input_size", input_size);
+    input_scale     = options.get_float("input_scale", input_scale);
+    tile_overlap    = options.get_int("tile_overlap", tile_overlap);
+    score_threshold = options.get_float("score_threshold", score_threshold);
+    class_id        = options.get_int("class_id", class_id);
+    options.warn_unused("[OnnxDetector]");
+
+    if (input_size <= 0) {
+        std::cerr << "[OnnxDetector] input_size must be positive.\n";
+        return false;
+    }
+    if (input_scale <= 0.f) {
+        std::cerr << "[OnnxDetector] input_scale must be positive.\n";
+        return false;
+    }
+    if (tile_overlap < 0 || tile_overlap >= input_size) {
+        std::cerr << "[OnnxDetector] tile_overlap must be in [0, input_size).\n";
+        return false;
+    }
+
+    planned_size_ = cv::Size();
+    tiles_.clear();
+    batch_ok_ = true;
+
+    try {
+        net_ = cv::dnn::readNetFromONNX(model_weights);
+    } catch (const cv::Exception& e) {
+        std::cerr << "[OnnxDetector] Failed to load model " << model_weights << ": " << e.what() << "\n";
+        return false;
+    }
+    if (net_.empty()) {
+        std::cerr << "[OnnxDetector] Empty network: " << model_weights << "\n";
+        return false;
+    }
+
+    net_.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+    net_.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+    out_names_ = net_.getUnconnectedOutLayersNames();
+
+    std::cout << "[OnnxDetector] Loaded " << model_weights << "  (input " << input_size
+              << "x" << input_size << ", scale " << input_scale << ")\n";
+    return true;
+}
+
+void OnnxDetector::warmup()
+{
+    if (net_.empty()) return;
+
+    Job job;
+    job.tiles.push_back(Tile{ cv::Rect(0, 0, input_size, input_size) });
+    const cv::Mat blank(input_size, input_size, CV_8UC3, cv::Scalar(114, 114, 114));
+    job.blob = cv::dnn::blobFromImage(blank, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false);
+
+    try {
+        infer(job);
+        std::cout << "[OnnxDetector] Warmup complete\n";
+    } catch (const cv::Exception& e) {
+        std::cerr << "[OnnxDetector] Warmup failed: " << e.what() << "\n";
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// detect
+// ─────────────────────────────────────────────────────────────────────────────
+
+DetectionResult OnnxDetector::detect(RawFrame& frame)
+{
+    if (net_.empty() || frame.data.empty()) return {};
+
+    return infer(preprocess(frame));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tiling & preprocessing
+// ─────────────────────────────────────────────────────────────────────────────
+
+void OnnxDetector::plan_tiles(cv::Size frame_size)
+{
+    if (frame_size == planned_size_) return;
+    planned_size_ = frame_size;
+    tiles_.clear();
+
+    // Source pixels per tile side; even so I420 chroma stays aligned
+    const int span    = static_cast<int>(std::lround(input_size / input_scale)) & ~1;
+    const int overlap = static_cast<int>(std::lround(tile_overlap / input_scale));
+    const int tw      = std::min(span, frame_size.width)  & ~1;
+    const int th      = std::min(span, frame_size.height) & ~1;
+    const int stride  = std::max(2, (span - overlap) & ~1);
+
+    for (int y : tile_origins(frame_size.height, th, stride)) {
+        for (int x : tile_origins(frame_size.width, tw, stride)) {
+            Tile t;
+            t.src = cv::Rect(x, y, tw, th);
+            t.sx  = static_cast<float>(input_size) / static_cast<float>(tw);
+            t.sy  = static_cast<float>(input_size) / static_cast<float>(th);
+            tiles_.push_back(t);
+        }
+    }
+
+    std::cout << "[OnnxDetector] " << frame_size.width << "x" << frame_size.height
+              << " → " << tiles_.size() << " tiles of " << tw << "x" << th << " px\n";
+}
+
+OnnxDetector::Job OnnxDetector::preprocess(const RawFrame& frame)
+{
+    plan_tiles(image_size(frame.data, frame.format));
+
+    Job job;
+    job.tiles = tiles_;
+
+    std::vector<cv::Mat> patches;
+    patches.reserve(job.tiles.size());
+    for (const Tile& t : job.tiles) {
+        cv::Rect roi   = t.src;
+        cv::Mat  bgr   = crop_to_bgr(frame.data, frame.format, roi);
+        cv::Mat  patch;
+        cv::resize(bgr, patch, cv::Size(input_size, input_size), 0, 0, cv::INTER_AREA);
+        patches.push_back(patch);
+    }
+
+    // NCHW float, RGB, [0, 1]
+    job.blob = cv::dnn::blobFromImages(patches, 1.0 / 255.0, cv::Size(), cv::Scalar(), true, false);
+    return job;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Inference & decoding
+// ─────────────────────────────────────────────────────────────────────────────
+
+DetectionResult OnnxDetector::infer(const Job& job)
+{
+    const int n = static_cast<int>(job.tiles.size());
+
+    // One 2-D (rows x cols) prediction matrix per tile. The batched ones are
+    // views into `outs`, which therefore lives until decoding is done.
+    std::vector<cv::Mat> predictions;
+    std::vector<cv::Mat> outs;
+
+    if (batch_ok_ && n > 1) {
+        try {
+            net_.setInput(job.blob);
+            net_.forward(outs, out_names_);
+            const cv::Mat& out = outs.front();
+            if (out.dims == 3 && out.size[0] == n) {
+                for (int i = 0; i < n; ++i) {
+                    predictions.emplace_back(out.size[1], out.size[2], CV_32F,
+                                             const_cast<float*>(out.ptr<float>(i)));
+                }
+            }
+        } catch (const cv::Exception&) {
+            predictions.clear();
+            outs.clear();
+        }
+        if (predictions.empty()) {
+            batch_ok_ = false;
+            std::cerr << "[OnnxDetector] Model does not accept a batch of " << n
+                      << " — running tiles one by one.\n";
+        }
+    }
+
+    if (predictions.empty()) {
+        // A failed forward pass must not escape: detect() runs on the
+        // pipeline's detect thread, which has no handler of its own
+        try {
+            const int shape[] = { 1, 3, input_size, input_size };
+            for (int i = 0; i < n; ++i) {
+                const cv::Mat one(4, shape, CV_32F, const_cast<float*>(job.blob.ptr<float>(i)));
+                net_.setInput(one);
+                net_.forward(outs, out_names_);
+                const cv::Mat& out = outs.front();
+                const int rows = out.dims == 3 ? out.size[1] : out.size[0];
+                const int cols = out.dims == 3 ? out.size[2] : out.size[1];
+                // forward() may reuse its output buffer on the next call
+                predictions.push_back(cv::Mat(rows, cols, CV_32F,
+                                              const_cast<float*>(out.ptr<float>())).clone());
+            }
+        } catch (const cv::Exception& e) {
+            std::cerr << "[OnnxDetector] Inference failed: " << e.what() << "\n";
+            return {};
+        }
+    }
+
+    // ── Highest-scoring box over all tiles ───────────────────────────────────
+    // Duplicates in the tile overlaps do not matter for the argmax, so no NMS.
+    DetectionResult best;
+    best.confidence = score_threshold;
+
+    for (int i = 0; i < n; ++i) {
+        const cv::Mat& m    = predictions[i];
+        const Tile&    tile = job.tiles[i];
+
+        // YOLOv8: [4 + C, anchors]; YOLOv5: [anchors, 5 + C] with objectness
+        const bool   v8      = m.rows < m.cols;
+        const int    anchors = v8 ? m.cols : m.rows;
+        const int    attrs   = v8 ? m.rows : m.cols;
+        const int    first   = v8 ? 4 : 5;
+        const int    classes = attrs - first;
+        const float* p       = m.ptr<float>();
+        if (classes <= 0 || class_id >= classes) continue;
+
+        auto at = [&](int a, int k) { return v8 ? p[k * anchors + a] : p[a * attrs + k]; };
+
+        for (int a = 0; a < anchors; ++a) {
+            const float objectness = v8 ? 1.f : at(a, 4);
+            if (objectness <= best.confidence) continue;
+
+            float cls = 0.f;
+            if (class_id >= 0) {
+                cls = at(a, first + class_id);
+            } else {
+                for (int c = 0; c < classes; ++c) cls = std::max(cls, at(a, first + c));
+            }
+
+            const float score = objectness * cls;
+            if (score <= best.confidence) continue;
+
+            best.confidence = score;
+            best.center     = { static_cast<float>(tile.src.x) + at(a, 0) / tile.sx,
+                                static_cast<float>(tile.src.y) + at(a, 1) / tile.sy };
+            best.valid      = true;
+        }
+    }
+
+    if (!best.valid) best.confidence = 0.f;
+    return best;
+}
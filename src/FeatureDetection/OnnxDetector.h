@@ -0,0 +1,78 @@
+#pragma once
+
+#include "interfaces.h"
+
+#include <opencv2/dnn.hpp>
+
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// OnnxDetector
+//
+// Object detection with a YOLO-style ONNX model through cv::dnn on the CPU.
+// Drop-in replacement for ORBDetector: detect() returns the centre of the
+// highest-scoring box.
+//
+//   init("", "models/yolov8n.onnx", "")
+//
+// Design:
+//   - The frame is scaled by input_scale and cut into input_size x
+//     input_size tiles overlapping by tile_overlap model pixels, so small
+//     objects in the 4K frame keep enough pixels for the model
+//   - Only each tile's region is converted to BGR (crop_to_bgr) — the full
+//     frame never is
+//   - All tiles of a frame go through one batched forward pass; models
+//     exported with a fixed batch of 1 fall back to one pass per tile
+//   - Inference is synchronous: detect() reports on the frame it is given,
+//     which TrackingDetector needs to seed its track at the right place
+//   - A failed forward pass is logged and yields an invalid result
+//   - Output layout is read from the output shape: [4+C, A] (YOLOv8) or
+//     [A, 5+C] (YOLOv5, with objectness)
+// ─────────────────────────────────────────────────────────────────────────────
+
+class OnnxDetector : public IFeatureDetector {
+public:
+    int   input_size      = 640;     // model input, square
+    float input_scale     = 0.5f;    // source → model pixels before tiling
+    int   tile_overlap    = 32;      // model pixels shared by adjacent tiles
+    float score_threshold = 0.35f;
+    int   class_id        = -1;      // report only this class; -1 = any
+
+    OnnxDetector() = default;
+
+    // model_weights: path to the .onnx file. model_config may override the
+    // fields above, e.g. "input_scale=0.25,class_id=0". reference_image is
+    // unused.
+    bool init(const std::string& model_config,
+              const std::string& model_weights,
+              const std::string& reference_image) override;
+
+    DetectionResult detect(RawFrame& frame) override;
+
+    // One forward pass on a blank tile (allocates the network's buffers).
+    void warmup() override;
+
+private:
+    struct Tile {
+        cv::Rect src;        // region of the source frame
+        float    sx = 1.f;   // model px per source px
+        float    sy = 1.f;
+    };
+
+    struct Job {
+        cv::Mat           blob;    // N x 3 x input_size x input_size
+        std::vector<Tile> tiles;
+    };
+
+    void            plan_tiles(cv::Size frame_size);
+    Job             preprocess(const RawFrame& frame);
+    DetectionResult infer(const Job& job);
+
+    cv::dnn::Net             net_;
+    std::vector<std::string> out_names_;
+    bool                     batch_ok_ = true;   // false once batched forward failed
+
+    cv::Size                 planned_size_;
+    std::vector<Tile>        tiles_;
+};
@@ -1,4 +1,5 @@
 #include "FeatureDetection/StubDetector.h"
+#include "Common/ImageOps.h"
 #include <iostream>
 
 bool StubDetector::init(const std::string&, const std::string&,
@@ -11,9 +12,10 @@ bool StubDetector::init(const std::string&, const std::string&,
 DetectionResult StubDetector::detect(RawFrame& frame)
 {
     // Always report the geometric centre of the source frame.
+    const cv::Size size = image_size(frame.data, frame.format);
     DetectionResult r;
-    r.center     = { static_cast<float>(frame.data.cols) / 2.f,
-                     static_cast<float>(frame.data.rows) / 2.f };
+    r.center     = { static_cast<float>(size.width) / 2.f,
+                     static_cast<float>(size.height) / 2.f };
     r.confidence = 1.f;
     r.valid      = true;
     return r;
@@ -0,0 +1,113 @@
+#include "FeatureDetection/TiledOrbExtractor.h"
+
+#include <algorithm>
+#include <cmath>
+
+int TiledOrbExtractor::tile_margin(const cv::Ptr<cv::ORB>& orb)
+{
+    const int    border = std::max(orb->getEdgeThreshold(), orb->getPatchSize());
+    const double scale  = std::pow(orb->getScaleFactor(), std::max(orb->getNLevels() - 1, 0));
+    return static_cast<int>(std::ceil(border * scale));
+}
+
+void TiledOrbExtractor::prepare(const cv::Ptr<cv::ORB>& orb, int tiles)
+{
+    if (orb == source_orb_ && static_cast<int>(tile_orbs_.size()) == tiles) return;
+
+    source_orb_ = orb;
+    tile_orbs_.clear();
+
+    const int budget = (orb->getMaxFeatures() + tiles - 1) / tiles;
+    for (int i = 0; i < tiles; ++i) {
+        tile_orbs_.push_back(cv::ORB::create(budget,
+                                             static_cast<float>(orb->getScaleFactor()),
+                                             orb->getNLevels(),
+                                             orb->getEdgeThreshold(),
+                                             orb->getFirstLevel(),
+                                             orb->getWTA_K(),
+                                             orb->getScoreType(),
+                                             orb->getPatchSize(),
+                                             orb->getFastThreshold()));
+    }
+}
+
+void TiledOrbExtractor::detect_and_compute(const cv::Ptr<cv::ORB>&    orb,
+                                           const cv::Mat&             image,
+                                           std::vector<cv::KeyPoint>& keypoints,
+                                           cv::Mat&                   descriptors)
+{
+    const int step = std::max(tile_size, 64);
+    const int cols = std::max(1, (image.cols + step / 2) / step);
+    const int rows = std::max(1, (image.rows + step / 2) / step);
+    const int n    = cols * rows;
+
+    if (n == 1) {
+        orb->detectAndCompute(image, cv::noArray(), keypoints, descriptors);
+        return;
+    }
+
+    prepare(orb, n);
+    const int      margin = tile_margin(orb);
+    const cv::Rect bounds(0, 0, image.cols, image.rows);
+
+    std::vector<std::vector<cv::KeyPoint>> tile_kps(n);
+    std::vector<cv::Mat>                   tile_desc(n);
+
+    cv::parallel_for_(cv::Range(0, n), [&](const cv::Range& range) {
+        for (int t = range.start; t < range.end; ++t) {
+            const int tx = t % cols;
+            const int ty = t / cols;
+
+            // Tile proper (owned keypoints) and its padded extraction area
+            const cv::Rect core(tx * image.cols / cols, ty * image.rows / rows,
+                                (tx + 1) * image.cols / cols - tx * image.cols / cols,
+                                (ty + 1) * image.rows / rows - ty * image.rows / rows);
+            const cv::Rect padded = cv::Rect(core.x - margin, core.y - margin,
+                                             core.width + 2 * margin,
+                                             core.height + 2 * margin) & bounds;
+
+            std::vector<cv::KeyPoint> kps;
+            cv::Mat                   desc;
+            tile_orbs_[t]->detectAndCompute(image(padded), cv::noArray(), kps, desc);
+
+            // Keep what falls inside the core, in frame coordinates
+            const cv::Point2f offset(static_cast<float>(padded.x), static_cast<float>(padded.y));
+            std::vector<cv::KeyPoint>& out_kps = tile_kps[t];
+            cv::Mat&                   out_desc = tile_desc[t];
+            out_kps.reserve(kps.size());
+            out_desc.create(static_cast<int>(kps.size()), desc.cols, desc.type());
+
+            int kept = 0;
+            for (std::size_t i = 0; i < kps.size(); ++i) {
+                cv::KeyPoint kp = kps[i];
+                kp.pt += offset;
+                if (kp.pt.x < core.x || kp.pt.y < core.y ||
+                    kp.pt.x >= core.x + core.width || kp.pt.y >= core.y + core.height) {
+                    continue;
+                }
+                desc.row(static_cast<int>(i)).copyTo(out_desc.row(kept++));
+                out_kps.push_back(kp);
+            }
+            out_desc = out_desc.rowRange(0, kept);
+        }
+    });
+
+    // ── Merge in tile order (deterministic) ──────────────────────────────────
+    std::size_t total = 0;
+    for (const auto& k : tile_kps) total += k.size();
+
+    keypoints.clear();
+    keypoints.reserve(total);
+    std::vector<cv::Mat> blocks;
+    for (int t = 0; t < n; ++t) {
+        if (tile_kps[t].empty()) continue;
+        keypoints.insert(keypoints.end(), tile_kps[t].begin(), tile_kps[t].end());
+        blocks.push_back(tile_desc[t]);
+    }
+
+    if (blocks.empty()) {
+        descriptors.release();
+    } else {
+        cv::vconcat(blocks, descriptors);
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+#include <opencv2/features2d.hpp>
+
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TiledOrbExtractor
+//
+// Parallel drop-in for orb->detectAndCompute(image, noArray(), kps, desc):
+// the image is split into a grid of roughly tile_size tiles and every tile
+// runs its own ORB on a worker thread (cv::parallel_for_).
+//
+//   TiledOrbExtractor extractor;
+//   extractor.detect_and_compute(orb, gray, keypoints, descriptors);
+//
+// Design:
+//   - Each tile is extracted from a padded view that reaches
+//     max(edgeThreshold, patchSize) · scaleFactor^(nlevels-1) pixels into
+//     its neighbours — the border ORB needs at the coarsest pyramid level —
+//     and only keypoints inside the tile itself are kept, so seams neither
+//     lose nor duplicate features
+//   - The feature budget is split evenly between tiles (each tile's ORB
+//     gets nfeatures / tiles), which spreads keypoints over the whole frame
+//     instead of clustering them on the strongest texture, and gives the
+//     homography fits better-conditioned point sets
+//   - Output has the same layout as a single detectAndCompute call (frame
+//     coordinates, one CV_8U descriptor row per keypoint) in a fixed tile
+//     order, so it can go straight into FrameCache::keypoints/descriptors
+//   - Images that fit in a single tile use `orb` directly
+//   - Per-tile ORB instances are rebuilt when a different `orb` is passed;
+//     change parameters by passing a new ORB, not by mutating the old one
+// ─────────────────────────────────────────────────────────────────────────────
+
+class TiledOrbExtractor {
+public:
+    int tile_size = 1024;   // target tile side in pixels
+
+    void detect_and_compute(const cv::Ptr<cv::ORB>&    orb,
+                            const cv::Mat&             image,
+                            std::vector<cv::KeyPoint>& keypoints,
+                            cv::Mat&                   descriptors);
+
+    // Pixels a tile reaches into its neighbours for `orb`.
+    static int tile_margin(const cv::Ptr<cv::ORB>& orb);
+
+private:
+    void prepare(const cv::Ptr<cv::ORB>& orb, int tiles);
+
+    cv::Ptr<cv::ORB>              source_orb_;   // the ORB tile_orbs_ were cloned from
+    std::vector<cv::Ptr<cv::ORB>> tile_orbs_;    // one per tile (ORB is not shared across threads)
+};
@@ -0,0 +1,152 @@
+#include "FeatureDetection/TrackingDetector.h"
+#include "Common/FrameCache.h"
+
+#include <opencv2/imgproc.hpp>
+#include <opencv2/video.hpp>
+
+#include <algorithm>
+#include <iostream>
+
+namespace {
+
+float median(std::vector<float>& v)
+{
+    auto mid = v.begin() + static_cast<std::ptrdiff_t>(v.size() / 2);
+    std::nth_element(v.begin(), mid, v.end());
+    return *mid;
+}
+
+} // namespace
+
+TrackingDetector::TrackingDetector(std::unique_ptr<IFeatureDetector> detector)
+    : detector_(std::move(detector))
+{
+}
+
+bool TrackingDetector::init(const std::string& model_config,
+                            const std::string& model_weights,
+                            const std::string& reference_image)
+{
+    prev_pyr_.clear();
+    points_.clear();
+    last_         = DetectionResult{};
+    since_detect_ = 0;
+    force_detect_ = true;
+
+    std::cout << "[TrackingDetector] Detecting every " << detect_every_n
+              << " frames, LK tracking in between\n";
+    return detector_->init(model_config, model_weights, reference_image);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// detect
+// ─────────────────────────────────────────────────────────────────────────────
+
+DetectionResult TrackingDetector::detect(RawFrame& frame)
+{
+    if (frame.data.empty()) return {};
+
+    const cv::Size              lk_win(lk_win_size, lk_win_size);
+    const std::vector<cv::Mat>& pyr = cached_lk_pyramid(frame, lk_win, lk_max_level);
+
+    // ── Track from the previous frame while the track is alive ───────────────
+    DetectionResult tracked;
+    if (last_.valid && !points_.empty() && !prev_pyr_.empty()) {
+        tracked = track(pyr, cached_gray(frame).size());
+    }
+    const bool weak = !tracked.valid || tracked.confidence < min_confidence;
+
+    // ── Full detection on schedule, or as soon as tracking weakens ──────────
+    ++since_detect_;
+    DetectionResult result = tracked;
+    if (force_detect_ || weak || since_detect_ >= detect_every_n) {
+        const DetectionResult detected = detector_->detect(frame);
+        since_detect_ = 0;
+
+        if (detected.valid && !detected.predicted) {
+            result           = detected;
+            base_confidence_ = detected.confidence;
+            force_detect_    = !seed(frame, detected.center);
+        } else {
+            // Keep a healthy track until the next scheduled detection;
+            // without one, pass on the detector's own prediction (if any)
+            if (!tracked.valid) result = detected;
+            force_detect_ = weak;
+        }
+    }
+
+    if (!result.valid) points_.clear();
+    prev_pyr_ = pyr;     // shares buffers with the frame cache, no copy
+    last_     = result;
+    return result;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Tracking
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool TrackingDetector::seed(const RawFrame& frame, cv::Point2f center)
+{
+    points_.clear();
+
+    const cv::Mat& gray = cached_gray(frame);
+    const cv::Rect roi  = cv::Rect(static_cast<int>(center.x) - track_radius,
+                                   static_cast<int>(center.y) - track_radius,
+                                   2 * track_radius, 2 * track_radius) &
+                          cv::Rect(0, 0, gray.cols, gray.rows);
+    if (roi.area() == 0) return false;
+
+    cv::goodFeaturesToTrack(gray(roi), points_, max_points, 0.01, 7.0);
+    const cv::Point2f offset(static_cast<float>(roi.x), static_cast<float>(roi.y));
+    for (auto& p : points_) p += offset;
+
+    seeded_count_ = points_.size();
+    if (static_cast<int>(points_.size()) < min_points) {
+        points_.clear();
+        return false;
+    }
+    return true;
+}
+
+DetectionResult TrackingDetector::track(const std::vector<cv::Mat>& pyr, cv::Size frame_size)
+{
+    DetectionResult r;
+
+    const cv::Size           lk_win(lk_win_size, lk_win_size);
+    std::vector<cv::Point2f> next, back;
+    std::vector<uchar>       status, back_status;
+    std::vector<float>       err;
+
+    cv::calcOpticalFlowPyrLK(prev_pyr_, pyr, points_, next, status, err, lk_win, lk_max_level);
+    cv::calcOpticalFlowPyrLK(pyr, prev_pyr_, next, back, back_status, err, lk_win, lk_max_level);
+
+    // Forward-backward check: a point must come back to where it started
+    std::vector<cv::Point2f> kept;
+    std::vector<float>       dx, dy;
+    kept.reserve(points_.size());
+    dx.reserve(points_.size());
+    dy.reserve(points_.size());
+    for (std::size_t i = 0; i < points_.size(); ++i) {
+        if (!status[i] || !back_status[i]) continue;
+        const cv::Point2f fb = back[i] - points_[i];
+        if (fb.dot(fb) > max_fb_error * max_fb_error) continue;
+
+        kept.push_back(next[i]);
+        dx.push_back(next[i].x - points_[i].x);
+        dy.push_back(next[i].y - points_[i].y);
+    }
+
+    points_ = std::move(kept);
+    if (static_cast<int>(points_.size()) < min_points) return r;
+
+    const cv::Point2f center = last_.center + cv::Point2f(median(dx), median(dy));
+    if (center.x < 0 || center.y < 0 || center.x >= frame_size.width || center.y >= frame_size.height) {
+        return r;
+    }
+
+    r.center     = center;
+    r.confidence = base_confidence_ * static_cast<float>(points_.size()) /
+                   static_cast<float>(std::max<std::size_t>(seeded_count_, 1));
+    r.valid      = true;
+    return r;
+}
@@ -0,0 +1,75 @@
+#pragma once
+
+#include "interfaces.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TrackingDetector
+//
+// Detect-then-track wrapper around any IFeatureDetector. The wrapped
+// detector runs every detect_every_n frames (or sooner when tracking gets
+// unreliable); in between, the object is followed with pyramidal LK on
+// corners around the last known centre, so every frame gets a result.
+//
+//   auto tracker = std::make_unique<TrackingDetector>(std::make_unique<ORBDetector>());
+//   tracker->detect_every_n = 5;
+//
+// Design:
+//   - Tracking uses the frame cache's LK pyramid with the OFStabilizer
+//     parameters (21x21, 3 levels), so the stabilizer reuses it
+//   - Points are checked forward-backward; the centre moves by the median
+//     displacement of the survivors, which ignores a minority of points on
+//     background or occluders
+//   - Confidence decays with the fraction of points still tracked; falling
+//     below min_confidence (or min_points) triggers a detection on the next
+//     frame
+//   - A failed detection does not drop a healthy track — it keeps tracking
+//     until the next scheduled detection
+//   - The wrapped detector must report on the frame it is given: a result
+//     from an earlier frame would seed the track at a stale position
+// ─────────────────────────────────────────────────────────────────────────────
+
+class TrackingDetector : public IFeatureDetector {
+public:
+    int   detect_every_n = 5;      // full detection cadence (1 = every frame)
+    float min_confidence = 0.3f;   // re-detect below this
+    int   track_radius   = 160;    // px, half-size of the region seeded with points
+    int   max_points     = 80;
+    int   min_points     = 8;      // track lost below this
+    float max_fb_error   = 1.f;    // px, forward-backward consistency
+
+    explicit TrackingDetector(std::unique_ptr<IFeatureDetector> detector);
+
+    bool init(const std::string& model_config,
+              const std::string& model_weights,
+              const std::string& reference_image) override;
+
+    DetectionResult detect(RawFrame& frame) override;
+
+    void warmup() override { detector_->warmup(); }
+
+    IFeatureDetector* wrapped() const { return detector_.get(); }
+
+private:
+    static constexpr int lk_win_size  = 21;   // matches OFStabilizer
+    static constexpr int lk_max_level = 3;
+
+    // Pick corners around `center`; false if too few.
+    bool            seed(const RawFrame& frame, cv::Point2f center);
+
+    // Follow points_ from prev_pyr_ into `pyr`; invalid if the track is lost.
+    DetectionResult track(const std::vector<cv::Mat>& pyr, cv::Size frame_size);
+
+    std::unique_ptr<IFeatureDetector> detector_;
+
+    std::vector<cv::Mat>     prev_pyr_;
+    std::vector<cv::Point2f> points_;
+    std::size_t              seeded_count_ = 0;
+    DetectionResult          last_;              // latest result (detected or tracked)
+    float                    base_confidence_ = 0.f;
+    int                      since_detect_    = 0;
+    bool                     force_detect_    = true;
+};
@@ -0,0 +1,68 @@
+#include "Geometry/PhaseCorrelator.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+
+void PhaseCorrelator::configure(cv::Size size)
+{
+    if (size == size_) return;
+    size_ = size;
+
+    cv::createHanningWindow(window_, size, CV_32F);
+    windowed_.create(size, CV_32F);
+    cross_.create(size, CV_32FC2);
+    surface_.create(size, CV_32F);
+}
+
+void PhaseCorrelator::transform(const cv::Mat& image, cv::Mat& spectrum)
+{
+    CV_Assert(image.type() == CV_32FC1 && image.size() == size_);
+
+    cv::multiply(image, window_, windowed_);
+    cv::dft(windowed_, spectrum, cv::DFT_COMPLEX_OUTPUT);
+}
+
+cv::Point2d PhaseCorrelator::correlate(const cv::Mat& a, const cv::Mat& b, double& response)
+{
+    CV_Assert(a.type() == CV_32FC2 && a.size() == size_ && b.type() == a.type() &&
+              b.size() == size_);
+
+    // ── Normalised cross-power spectrum A · conj(B) / |A · conj(B)| ──────────
+    cv::mulSpectrums(a, b, cross_, 0, true);
+    for (int y = 0; y < size_.height; ++y) {
+        float* p = cross_.ptr<float>(y);
+        for (int x = 0; x < size_.width; ++x, p += 2) {
+            const float mag = std::sqrt(p[0] * p[0] + p[1] * p[1]);
+            const float inv = mag > 1e-12f ? 1.f / mag : 0.f;
+            p[0] *= inv;
+            p[1] *= inv;
+        }
+    }
+    cv::idft(cross_, surface_, cv::DFT_REAL_OUTPUT | cv::DFT_SCALE);
+
+    // ── Peak, refined by the 5x5 weighted centroid (wrapping) ────────────────
+    cv::Point peak;
+    cv::minMaxLoc(surface_, nullptr, nullptr, nullptr, &peak);
+
+    double sum = 0.0, sx = 0.0, sy = 0.0;
+    for (int dy = -2; dy <= 2; ++dy) {
+        const int    y   = (peak.y + dy + size_.height) % size_.height;
+        const float* row = surface_.ptr<float>(y);
+        for (int dx = -2; dx <= 2; ++dx) {
+            const int    x = (peak.x + dx + size_.width) % size_.width;
+            const double w = std::max(row[x], 0.f);
+            sum += w;
+            sx  += w * dx;
+            sy  += w * dy;
+        }
+    }
+    response = std::min(sum, 1.0);
+
+    cv::Point2d shift(peak.x, peak.y);
+    if (sum > 0.0) shift += cv::Point2d(sx / sum, sy / sum);
+    if (shift.x > size_.width  / 2.0) shift.x -= size_.width;
+    if (shift.y > size_.height / 2.0) shift.y -= size_.height;
+    return shift;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PhaseCorrelator
+//
+// FFT phase correlation between images of one fixed size, split into a
+// per-image transform() and a per-pair correlate() so a sequence only
+// transforms each frame once (cv::phaseCorrelate transforms both images and
+// reallocates on every call).
+//
+//   PhaseCorrelator pc;
+//   pc.configure(cv::Size(512, 384));
+//   pc.transform(prev_small, prev_spec);
+//   pc.transform(curr_small, curr_spec);
+//   double response;
+//   cv::Point2d shift = pc.correlate(curr_spec, prev_spec, response);
+//
+// Design:
+//   - Images are Hann-windowed before the forward DFT so the frame borders
+//     do not dominate the spectrum
+//   - The cross-power spectrum is normalised to unit magnitude, so the
+//     inverse DFT is a sharp peak at the shift whose height (response,
+//     0..1) says how much of the image moved together
+//   - Sub-pixel peak position from the 5x5 weighted centroid around the
+//     maximum, wrapping at the borders; shifts beyond half the image wrap
+//     to negative values
+//   - The window and all intermediate buffers are allocated in configure()
+//     and reused; OpenCV's DFT has no plan objects, but with fixed sizes
+//     and preallocated outputs it does not allocate per call either
+// ─────────────────────────────────────────────────────────────────────────────
+
+class PhaseCorrelator {
+public:
+    // Allocate for `size` (no-op if unchanged).
+    void     configure(cv::Size size);
+    cv::Size size() const { return size_; }
+
+    // Windowed forward DFT (CV_32FC2) of a CV_32FC1 image of size().
+    // `spectrum` is reused when it already has the right shape.
+    void transform(const cv::Mat& image, cv::Mat& spectrum);
+
+    // Shift d such that a(x) ≈ b(x - d), from two transform() results.
+    cv::Point2d correlate(const cv::Mat& a, const cv::Mat& b, double& response);
+
+private:
+    cv::Size size_;
+    cv::Mat  window_;      // Hann, CV_32F
+    cv::Mat  windowed_;
+    cv::Mat  cross_;       // normalised cross-power spectrum
+    cv::Mat  surface_;     // correlation surface
+};
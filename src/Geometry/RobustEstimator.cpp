@@ -0,0 +1,480 @@
+#include "Geometry/RobustEstimator.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <numeric>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define ROBUST_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Inliers among `n` SoA points for the 3x3 model `h` (row-major); writes
+// 0/1 per point into `mask` when non-null.
+using ScoreKernel = int (*)(const float* h,
+                            const float* sx, const float* sy,
+                            const float* dx, const float* dy,
+                            int n, float thr2, uchar* mask);
+
+// ── Portable ─────────────────────────────────────────────────────────────────
+
+int score_scalar(const float* h, const float* sx, const float* sy,
+                 const float* dx, const float* dy, int n, float thr2, uchar* mask)
+{
+    int count = 0;
+    for (int i = 0; i < n; ++i) {
+        const float x  = sx[i];
+        const float y  = sy[i];
+        const float iw = 1.f / (h[6] * x + h[7] * y + h[8]);
+        const float u  = (h[0] * x + h[1] * y + h[2]) * iw - dx[i];
+        const float v  = (h[3] * x + h[4] * y + h[5]) * iw - dy[i];
+        const int   in = u * u + v * v <= thr2;     // NaN (w = 0) is an outlier
+        if (mask) mask[i] = static_cast<uchar>(in);
+        count += in;
+    }
+    return count;
+}
+
+#ifdef ROBUST_X86_DISPATCH
+
+// ── AVX2 ─────────────────────────────────────────────────────────────────────
+
+__attribute__((target("avx2,fma")))
+int score_avx2(const float* h, const float* sx, const float* sy,
+               const float* dx, const float* dy, int n, float thr2, uchar* mask)
+{
+    const __m256 h0 = _mm256_set1_ps(h[0]), h1 = _mm256_set1_ps(h[1]), h2 = _mm256_set1_ps(h[2]);
+    const __m256 h3 = _mm256_set1_ps(h[3]), h4 = _mm256_set1_ps(h[4]), h5 = _mm256_set1_ps(h[5]);
+    const __m256 h6 = _mm256_set1_ps(h[6]), h7 = _mm256_set1_ps(h[7]), h8 = _mm256_set1_ps(h[8]);
+    const __m256 t  = _mm256_set1_ps(thr2);
+    const __m256 one = _mm256_set1_ps(1.f);
+
+    int count = 0;
+    int i     = 0;
+    for (; i + 8 <= n; i += 8) {
+        const __m256 x  = _mm256_loadu_ps(sx + i);
+        const __m256 y  = _mm256_loadu_ps(sy + i);
+        const __m256 w  = _mm256_fmadd_ps(h6, x, _mm256_fmadd_ps(h7, y, h8));
+        const __m256 iw = _mm256_div_ps(one, w);
+        const __m256 u  = _mm256_fmsub_ps(_mm256_fmadd_ps(h0, x, _mm256_fmadd_ps(h1, y, h2)), iw,
+                                          _mm256_loadu_ps(dx + i));
+        const __m256 v  = _mm256_fmsub_ps(_mm256_fmadd_ps(h3, x, _mm256_fmadd_ps(h4, y, h5)), iw,
+                                          _mm256_loadu_ps(dy + i));
+        const __m256 e  = _mm256_fmadd_ps(u, u, _mm256_mul_ps(v, v));
+        const int    in = _mm256_movemask_ps(_mm256_cmp_ps(e, t, _CMP_LE_OQ));
+
+        count += __builtin_popcount(static_cast<unsigned>(in));
+        if (mask) {
+            for (int k = 0; k < 8; ++k) mask[i + k] = static_cast<uchar>((in >> k) & 1);
+        }
+    }
+    return count + score_scalar(h, sx + i, sy + i, dx + i, dy + i, n - i, thr2,
+                                mask ? mask + i : nullptr);
+}
+
+#endif // ROBUST_X86_DISPATCH
+
+// ── Dispatch ─────────────────────────────────────────────────────────────────
+
+bool has_avx2()
+{
+#ifdef ROBUST_X86_DISPATCH
+    static const bool avx2 = __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+ScoreKernel score_kernel()
+{
+#ifdef ROBUST_X86_DISPATCH
+    if (has_avx2()) return score_avx2;
+#endif
+    return score_scalar;
+}
+
+// Points scored per block before checking whether the hypothesis can still
+// beat the best one.
+constexpr int kScoreBlock = 256;
+
+// Solve the n x n system A x = b (n ≤ 8) by Gaussian elimination with
+// partial pivoting. A and b are overwritten; false if singular.
+bool solve_linear(double A[8][8], double b[8], int n)
+{
+    for (int c = 0; c < n; ++c) {
+        int pivot = c;
+        for (int r = c + 1; r < n; ++r) {
+            if (std::abs(A[r][c]) > std::abs(A[pivot][c])) pivot = r;
+        }
+        if (std::abs(A[pivot][c]) < 1e-12) return false;
+        if (pivot != c) {
+            std::swap_ranges(A[c], A[c] + n, A[pivot]);
+            std::swap(b[c], b[pivot]);
+        }
+        for (int r = c + 1; r < n; ++r) {
+            const double f = A[r][c] / A[c][c];
+            for (int k = c; k < n; ++k) A[r][k] -= f * A[c][k];
+            b[r] -= f * b[c];
+        }
+    }
+    for (int r = n - 1; r >= 0; --r) {
+        double s = b[r];
+        for (int k = r + 1; k < n; ++k) s -= A[r][k] * b[k];
+        b[r] = s / A[r][r];
+    }
+    return true;
+}
+
+// Twice the signed area of triangle (a, b, c).
+double cross(double ax, double ay, double bx, double by, double cx, double cy)
+{
+    return (bx - ax) * (cy - ay) - (by - ay) * (cx - ax);
+}
+
+// Centroid and scale taking the points to mean distance √2 (Hartley).
+bool normalisation(const float* xs, const float* ys, const int* idx, int n,
+                   double& cx, double& cy, double& s)
+{
+    cx = cy = 0.0;
+    for (int i = 0; i < n; ++i) {
+        cx += xs[idx[i]];
+        cy += ys[idx[i]];
+    }
+    cx /= n;
+    cy /= n;
+
+    double d = 0.0;
+    for (int i = 0; i < n; ++i) d += std::hypot(xs[idx[i]] - cx, ys[idx[i]] - cy);
+    d /= n;
+    if (d < 1e-9) return false;
+    s = std::sqrt(2.0) / d;
+    return true;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Public API
+// ─────────────────────────────────────────────────────────────────────────────
+
+int RobustEstimator::sample_size(MotionModel model)
+{
+    switch (model) {
+        case MotionModel::Translation:   return 1;
+        case MotionModel::AffinePartial: return 2;
+        default:                         return 4;
+    }
+}
+
+const char* RobustEstimator::kernel_name()
+{
+    return has_avx2() ? "avx2" : "scalar";
+}
+
+bool RobustEstimator::fit(const std::vector<cv::Point2f>& src,
+                          const std::vector<cv::Point2f>& dst,
+                          cv::Matx33d&                    model)
+{
+    const int n = static_cast<int>(src.size());
+    if (n != static_cast<int>(dst.size()) || n < sample_size(params.model)) return false;
+
+    sx_.resize(n); sy_.resize(n); dx_.resize(n); dy_.resize(n);
+    inlier_idx_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        sx_[i] = src[i].x; sy_[i] = src[i].y;
+        dx_[i] = dst[i].x; dy_[i] = dst[i].y;
+        inlier_idx_[i] = i;
+    }
+    return solve(inlier_idx_.data(), n, model);
+}
+
+bool RobustEstimator::estimate(const std::vector<cv::Point2f>& src,
+                               const std::vector<cv::Point2f>& dst,
+                               const std::vector<float>&       quality,
+                               cv::Matx33d&                    model,
+                               std::vector<uchar>*             inlier_mask)
+{
+    last_iterations_ = 0;
+    last_inliers_    = 0;
+    if (inlier_mask) inlier_mask->clear();
+
+    const int n = static_cast<int>(src.size());
+    const int m = sample_size(params.model);
+    const bool prosac = !quality.empty();
+    if (n != static_cast<int>(dst.size()) || n < m ||
+        (prosac && static_cast<int>(quality.size()) != n)) {
+        return false;
+    }
+
+    // ── Points in PROSAC order (best quality first), as SoA ──────────────────
+    order_.resize(n);
+    std::iota(order_.begin(), order_.end(), 0);
+    if (prosac) {
+        std::sort(order_.begin(), order_.end(), [&](int a, int b) {
+            return quality[a] < quality[b] || (quality[a] == quality[b] && a < b);
+        });
+    }
+    sx_.resize(n); sy_.resize(n); dx_.resize(n); dy_.resize(n);
+    mask_.resize(n);
+    for (int i = 0; i < n; ++i) {
+        const int j = order_[i];
+        sx_[i] = src[j].x; sy_[i] = src[j].y;
+        dx_[i] = dst[j].x; dy_[i] = dst[j].y;
+    }
+
+    rng_.seed(params.seed);
+    const int max_iterations = std::max(params.max_iterations, 1);
+    const double log_fail    = std::log(std::max(1.0 - params.confidence, 1e-12));
+
+    // PROSAC schedule: T_n is the expected number of samples drawn only
+    // from the top `pool` points among max_iterations plain RANSAC ones
+    int    pool      = m;
+    double T_n       = max_iterations;
+    for (int i = 0; i < m; ++i) T_n *= static_cast<double>(m - i) / (n - i);
+    double T_n_prime = 1.0;
+
+    int         limit      = max_iterations;
+    int         best_count = 0;
+    cv::Matx33d best;
+    int         sample[4];
+    int         t = 0;
+
+    while (t < limit) {
+        ++t;
+
+        // ── Draw a sample ─────────────────────────────────────────────────────
+        int range = n;
+        int fixed = -1;
+        if (prosac) {
+            if (t > T_n_prime && pool < n) {
+                const double T_next = T_n * (pool + 1) / (pool + 1 - m);
+                ++pool;
+                T_n_prime += std::ceil(T_next - T_n);
+                T_n        = T_next;
+            }
+            if (T_n_prime < t) {
+                range = pool;
+            } else {
+                // m - 1 from the pool so far, plus its newest point
+                range = pool - 1;
+                fixed = pool - 1;
+            }
+        }
+
+        int drawn = 0;
+        if (fixed >= 0) sample[drawn++] = fixed;
+        while (drawn < m) {
+            const int s = static_cast<int>(rng_() % static_cast<std::uint32_t>(range));
+            if (std::find(sample, sample + drawn, s) == sample + drawn) sample[drawn++] = s;
+        }
+
+        // ── Hypothesis ────────────────────────────────────────────────────────
+        cv::Matx33d hypothesis;
+        if (degenerate(sample) || !solve(sample, m, hypothesis)) continue;
+
+        const int count = score(hypothesis, best_count, false);
+        if (count <= best_count) continue;
+
+        best_count = count;
+        best       = hypothesis;
+
+        // Adaptive termination from the new inlier ratio. With PROSAC the
+        // ratio among the top-ranked points counts too (maximality), as
+        // long as that many inliers would be unlikely by chance
+        // (non-randomness, ~5% of random points agreeing with a model).
+        auto bound = [&](int inliers, int points) {
+            const double p_ok = std::pow(static_cast<double>(inliers) / points, m);
+            if (p_ok >= 1.0 - 1e-12) return 1.0;
+            return std::ceil(log_fail / std::log(1.0 - p_ok));
+        };
+        // The bound falls with the ratio, so only the best prefix matters.
+        int best_inliers = count, best_top = n;
+        if (prosac) {
+            score(hypothesis, -1, true);
+            int inliers = 0;
+            for (int top = 1; top <= n; ++top) {
+                inliers += mask_[top - 1];
+                if (top < 2 * m ||
+                    static_cast<long long>(inliers) * best_top <=
+                    static_cast<long long>(best_inliers) * top) {
+                    continue;
+                }
+                const double random = 0.05 * top + 3.0 * std::sqrt(0.05 * 0.95 * top);
+                if (inliers > random) {
+                    best_inliers = inliers;
+                    best_top     = top;
+                }
+            }
+        }
+        const double k = bound(best_inliers, best_top);
+        limit = static_cast<int>(std::min<double>(max_iterations, std::max<double>(k, t)));
+    }
+    last_iterations_ = t;
+    if (best_count < m) return false;
+
+    // ── Least-squares refit on the inliers ───────────────────────────────────
+    score(best, -1, true);
+    inlier_idx_.clear();
+    for (int i = 0; i < n; ++i) {
+        if (mask_[i]) inlier_idx_.push_back(i);
+    }
+
+    cv::Matx33d refined;
+    if (solve(inlier_idx_.data(), static_cast<int>(inlier_idx_.size()), refined)) {
+        const int count = score(refined, -1, true);
+        if (count >= best_count) {
+            best       = refined;
+            best_count = count;
+        } else {
+            score(best, -1, true);
+        }
+    }
+
+    model         = best;
+    last_inliers_ = best_count;
+    if (inlier_mask) {
+        inlier_mask->assign(n, 0);
+        for (int i = 0; i < n; ++i) (*inlier_mask)[order_[i]] = mask_[i];
+    }
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Scoring
+// ─────────────────────────────────────────────────────────────────────────────
+
+int RobustEstimator::score(const cv::Matx33d& model, int to_beat, bool with_mask)
+{
+    static const ScoreKernel kernel = score_kernel();
+
+    float h[9];
+    for (int i = 0; i < 9; ++i) h[i] = static_cast<float>(model.val[i]);
+    const float thr2 = static_cast<float>(params.threshold * params.threshold);
+
+    const int n     = static_cast<int>(sx_.size());
+    int       count = 0;
+    for (int begin = 0; begin < n; begin += kScoreBlock) {
+        const int len = std::min(kScoreBlock, n - begin);
+        count += kernel(h, sx_.data() + begin, sy_.data() + begin,
+                        dx_.data() + begin, dy_.data() + begin, len, thr2,
+                        with_mask ? mask_.data() + begin : nullptr);
+
+        // Even all remaining points would not make it the best
+        if (count + (n - begin - len) <= to_beat) return count;
+    }
+    return count;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Model solvers (indices into the SoA arrays)
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool RobustEstimator::degenerate(const int* idx) const
+{
+    switch (params.model) {
+        case MotionModel::Translation:
+            return false;
+
+        case MotionModel::AffinePartial:
+            return std::hypot(sx_[idx[0]] - sx_[idx[1]], sy_[idx[0]] - sy_[idx[1]]) < 1.0;
+
+        default: {
+            // No three points collinear, and every triangle keeps its
+            // orientation (a homography of a real plane cannot flip one)
+            for (int i = 0; i < 4; ++i) {
+                const int a = idx[i], b = idx[(i + 1) % 4], c = idx[(i + 2) % 4];
+                const double s = cross(sx_[a], sy_[a], sx_[b], sy_[b], sx_[c], sy_[c]);
+                const double d = cross(dx_[a], dy_[a], dx_[b], dy_[b], dx_[c], dy_[c]);
+                if (std::abs(s) < 1.0 || std::abs(d) < 1.0 || (s > 0) != (d > 0)) return true;
+            }
+            return false;
+        }
+    }
+}
+
+bool RobustEstimator::solve(const int* idx, int n, cv::Matx33d& model) const
+{
+    if (n < sample_size(params.model)) return false;
+
+    switch (params.model) {
+        case MotionModel::Translation: {
+            double tx = 0.0, ty = 0.0;
+            for (int i = 0; i < n; ++i) {
+                tx += dx_[idx[i]] - sx_[idx[i]];
+                ty += dy_[idx[i]] - sy_[idx[i]];
+            }
+            model = cv::Matx33d(1, 0, tx / n,
+                                0, 1, ty / n,
+                                0, 0, 1);
+            return true;
+        }
+
+        case MotionModel::AffinePartial: {
+            // Closed-form least squares for [a -b tx; b a ty] on centred points
+            double mx = 0, my = 0, nx = 0, ny = 0;
+            for (int i = 0; i < n; ++i) {
+                mx += sx_[idx[i]]; my += sy_[idx[i]];
+                nx += dx_[idx[i]]; ny += dy_[idx[i]];
+            }
+            mx /= n; my /= n; nx /= n; ny /= n;
+
+            double num_a = 0, num_b = 0, den = 0;
+            for (int i = 0; i < n; ++i) {
+                const double x = sx_[idx[i]] - mx, y = sy_[idx[i]] - my;
+                const double X = dx_[idx[i]] - nx, Y = dy_[idx[i]] - ny;
+                num_a += x * X + y * Y;
+                num_b += x * Y - y * X;
+                den   += x * x + y * y;
+            }
+            if (den < 1e-9) return false;
+
+            const double a = num_a / den;
+            const double b = num_b / den;
+            model = cv::Matx33d(a, -b, nx - (a * mx - b * my),
+                                b,  a, ny - (b * mx + a * my),
+                                0,  0, 1);
+            return true;
+        }
+
+        default: {
+            // Normalised DLT with h33 = 1: normal equations of the 2n x 8
+            // system (exact for n = 4)
+            double scx, scy, ss, dcx, dcy, ds;
+            if (!normalisation(sx_.data(), sy_.data(), idx, n, scx, scy, ss) ||
+                !normalisation(dx_.data(), dy_.data(), idx, n, dcx, dcy, ds)) {
+                return false;
+            }
+
+            double A[8][8] = {};
+            double b[8]    = {};
+            for (int i = 0; i < n; ++i) {
+                const double x = (sx_[idx[i]] - scx) * ss, y = (sy_[idx[i]] - scy) * ss;
+                const double X = (dx_[idx[i]] - dcx) * ds, Y = (dy_[idx[i]] - dcy) * ds;
+                const double r1[8] = { x, y, 1, 0, 0, 0, -x * X, -y * X };
+                const double r2[8] = { 0, 0, 0, x, y, 1, -x * Y, -y * Y };
+                for (int r = 0; r < 8; ++r) {
+                    for (int c = r; c < 8; ++c) A[r][c] += r1[r] * r1[c] + r2[r] * r2[c];
+                    b[r] += r1[r] * X + r2[r] * Y;
+                }
+            }
+            for (int r = 1; r < 8; ++r) {
+                for (int c = 0; c < r; ++c) A[r][c] = A[c][r];
+            }
+            if (!solve_linear(A, b, 8)) return false;
+
+            // Undo the normalisation: H = Td⁻¹ · Hn · Ts
+            const cv::Matx33d Hn(b[0], b[1], b[2], b[3], b[4], b[5], b[6], b[7], 1.0);
+            const cv::Matx33d Ts(ss, 0, -ss * scx, 0, ss, -ss * scy, 0, 0, 1);
+            const cv::Matx33d Td_inv(1 / ds, 0, dcx, 0, 1 / ds, dcy, 0, 0, 1);
+            const cv::Matx33d H = Td_inv * Hn * Ts;
+            if (std::abs(H(2, 2)) < 1e-12 || !std::isfinite(H(2, 2))) return false;
+
+            model = H * (1.0 / H(2, 2));
+            return true;
+        }
+    }
+}
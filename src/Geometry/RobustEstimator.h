@@ -0,0 +1,109 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// RobustEstimator
+//
+// RANSAC/PROSAC model fitting for point correspondences, replacing
+// cv::findHomography(RANSAC) / cv::estimateAffinePartial2D on the per-frame
+// paths with a bounded, allocation-free cost.
+//
+//   RobustEstimator estimator;
+//   estimator.params.model = MotionModel::Homography;
+//   cv::Matx33d H;
+//   std::vector<uchar> inliers;
+//   estimator.estimate(src, dst, match_distances, H, &inliers);
+//
+// Design:
+//   - Models: Translation (1-point), AffinePartial (rotation + uniform
+//     scale + translation, 2-point) and Homography (4-point normalised
+//     DLT). All are returned as a 3x3 matrix mapping src → dst
+//   - PROSAC: with a quality per correspondence (lower = better, e.g.
+//     Hamming distance) samples are drawn from the best-ranked points
+//     first and the pool grows on the PROSAC schedule; without one it is
+//     plain RANSAC. Sampling is seeded, so results are reproducible
+//   - Adaptive termination: the iteration bound log(1 - confidence) /
+//     log(1 - w^m) is recomputed from every new best inlier ratio w and
+//     capped by max_iterations, so clean data stops after a few dozen
+//     hypotheses
+//   - Scoring runs over structure-of-arrays float copies of the points in
+//     blocks, and stops a hypothesis as soon as it can no longer beat the
+//     best. The kernel is AVX2 (8 points per step) when the CPU has it,
+//     picked at runtime like HammingMatcher's, else portable
+//   - The winner is refitted by least squares on its inliers and
+//     re-scored, keeping the refit only if it explains at least as many
+//   - All scratch buffers are members and only grow, so steady-state
+//     calls do not allocate (apart from the optional output mask)
+// ─────────────────────────────────────────────────────────────────────────────
+
+enum class MotionModel {
+    Translation,
+    AffinePartial,
+    Homography
+};
+
+struct RobustParams {
+    MotionModel   model          = MotionModel::Homography;
+    double        threshold      = 3.0;      // px, reprojection error for an inlier
+    double        confidence     = 0.995;    // probability of an all-inlier sample
+    int           max_iterations = 1000;
+    std::uint32_t seed           = 0x5eed1234u;
+};
+
+class RobustEstimator {
+public:
+    RobustParams params;
+
+    RobustEstimator() = default;
+    explicit RobustEstimator(const RobustParams& p) : params(p) {}
+
+    // Fit params.model to src[i] → dst[i]. `quality` (empty, or one value
+    // per point, lower = more reliable) enables PROSAC ordering.
+    // `inlier_mask` (optional) receives 1 for inliers of the returned
+    // model. False if there are too few points or no non-degenerate
+    // hypothesis was found.
+    bool estimate(const std::vector<cv::Point2f>& src,
+                  const std::vector<cv::Point2f>& dst,
+                  const std::vector<float>&       quality,
+                  cv::Matx33d&                    model,
+                  std::vector<uchar>*             inlier_mask = nullptr);
+
+    // Least-squares fit of params.model to all of src → dst (no sampling).
+    bool fit(const std::vector<cv::Point2f>& src,
+             const std::vector<cv::Point2f>& dst,
+             cv::Matx33d&                    model);
+
+    // Statistics of the last estimate() call.
+    int last_iterations() const { return last_iterations_; }
+    int last_inliers()    const { return last_inliers_; }
+
+    // Points needed for one hypothesis of `model`.
+    static int sample_size(MotionModel model);
+
+    // Name of the scoring kernel used on this CPU.
+    static const char* kernel_name();
+
+private:
+    // Fit to the points listed in `idx` (minimal or least squares).
+    bool solve(const int* idx, int n, cv::Matx33d& model) const;
+    bool degenerate(const int* idx) const;
+
+    // Inliers of `model` over all points; stops early once the count can
+    // no longer exceed `to_beat`. Fills mask_ when `with_mask`.
+    int  score(const cv::Matx33d& model, int to_beat, bool with_mask);
+
+    // SoA copies of the points, in PROSAC order
+    std::vector<float> sx_, sy_, dx_, dy_;
+    std::vector<int>   order_;          // SoA position → caller's index
+    std::vector<uchar> mask_;           // SoA order
+    std::vector<int>   inlier_idx_;
+    std::mt19937       rng_;
+
+    int last_iterations_ = 0;
+    int last_inliers_    = 0;
+};
@@ -0,0 +1,126 @@
+#include "Matching/GuidedMatcher.h"
+#include "Matching/HammingMatcher.h"
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+void GuidedMatcher::build_grid(const std::vector<cv::KeyPoint>& keypoints, float cell)
+{
+    float min_x = std::numeric_limits<float>::max(), min_y = min_x;
+    float max_x = std::numeric_limits<float>::lowest(), max_y = max_x;
+    for (const auto& kp : keypoints) {
+        min_x = std::min(min_x, kp.pt.x);
+        min_y = std::min(min_y, kp.pt.y);
+        max_x = std::max(max_x, kp.pt.x);
+        max_y = std::max(max_y, kp.pt.y);
+    }
+
+    origin_    = cv::Point2f(min_x, min_y);
+    cell_      = cell;
+    grid_cols_ = static_cast<int>((max_x - min_x) / cell) + 1;
+    grid_rows_ = static_cast<int>((max_y - min_y) / cell) + 1;
+
+    auto cell_of = [&](const cv::Point2f& p) {
+        const int cx = static_cast<int>((p.x - origin_.x) / cell_);
+        const int cy = static_cast<int>((p.y - origin_.y) / cell_);
+        return cy * grid_cols_ + cx;
+    };
+
+    // Counting sort of keypoint indices by cell
+    cell_start_.assign(static_cast<std::size_t>(grid_cols_) * grid_rows_ + 1, 0);
+    for (const auto& kp : keypoints) ++cell_start_[cell_of(kp.pt) + 1];
+    for (std::size_t c = 1; c < cell_start_.size(); ++c) cell_start_[c] += cell_start_[c - 1];
+
+    cell_entries_.resize(keypoints.size());
+    std::vector<int> fill(cell_start_.begin(), cell_start_.end() - 1);
+    for (int i = 0; i < static_cast<int>(keypoints.size()); ++i) {
+        cell_entries_[fill[cell_of(keypoints[i].pt)]++] = i;
+    }
+}
+
+void GuidedMatcher::match(const std::vector<cv::KeyPoint>& frame_keypoints,
+                          const cv::Mat&                   frame_descriptors,
+                          const cv::Mat&                   reference_descriptors,
+                          const std::vector<cv::Point2f>&  predicted,
+                          float                            radius,
+                          std::vector<cv::DMatch>&         matches)
+{
+    matches.clear();
+
+    const int n_frame = frame_descriptors.rows;
+    const int n_ref   = reference_descriptors.rows;
+    if (n_frame == 0 || n_ref == 0 || radius <= 0.f ||
+        static_cast<int>(frame_keypoints.size()) != n_frame ||
+        static_cast<int>(predicted.size()) != n_ref ||
+        frame_descriptors.cols != reference_descriptors.cols ||
+        frame_descriptors.type() != CV_8U || reference_descriptors.type() != CV_8U) {
+        return;
+    }
+
+    // Cells at least radius wide, so the 3 x 3 neighbourhood covers the circle
+    build_grid(frame_keypoints, std::max(radius, 8.f));
+
+    const float r2 = radius * radius;
+    reference_best_.assign(n_ref, -1);
+    frame_best_.assign(n_frame, std::numeric_limits<std::uint64_t>::max());
+
+    for (int i = 0; i < n_ref; ++i) {
+        const cv::Point2f p = predicted[i];
+        if (!std::isfinite(p.x) || !std::isfinite(p.y)) continue;
+
+        // Cells overlapping the radius-sized box around the prediction
+        const float gx = (p.x - origin_.x) / cell_;
+        const float gy = (p.y - origin_.y) / cell_;
+        if (gx < -1.f || gy < -1.f || gx >= grid_cols_ + 1.f || gy >= grid_rows_ + 1.f) continue;
+
+        const int cx0 = std::max(static_cast<int>(std::floor(gx)) - 1, 0);
+        const int cy0 = std::max(static_cast<int>(std::floor(gy)) - 1, 0);
+        const int cx1 = std::min(static_cast<int>(std::floor(gx)) + 1, grid_cols_ - 1);
+        const int cy1 = std::min(static_cast<int>(std::floor(gy)) + 1, grid_rows_ - 1);
+
+        candidates_.clear();
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                const int c = cy * grid_cols_ + cx;
+                for (int e = cell_start_[c]; e < cell_start_[c + 1]; ++e) {
+                    const int j = cell_entries_[e];
+                    const cv::Point2f d = frame_keypoints[j].pt - p;
+                    if (d.x * d.x + d.y * d.y <= r2) candidates_.push_back(j);
+                }
+            }
+        }
+        if (candidates_.empty()) continue;
+
+        const int n = static_cast<int>(candidates_.size());
+        distances_.resize(n);
+        HammingMatcher::distances(reference_descriptors.ptr<std::uint8_t>(i), frame_descriptors,
+                                  candidates_.data(), n, distances_.data());
+
+        int best = -1, best_dist = std::numeric_limits<int>::max();
+        int second_dist = std::numeric_limits<int>::max();
+        for (int k = 0; k < n; ++k) {
+            if (distances_[k] < best_dist) {
+                second_dist = best_dist;
+                best_dist   = distances_[k];
+                best        = candidates_[k];
+            } else if (distances_[k] < second_dist) {
+                second_dist = distances_[k];
+            }
+        }
+
+        if (best_dist > max_distance) continue;
+        if (n > 1 && static_cast<float>(best_dist) >= ratio * static_cast<float>(second_dist)) continue;
+
+        reference_best_[i] = best;
+        const std::uint64_t packed = (static_cast<std::uint64_t>(best_dist) << 32) |
+                                     static_cast<std::uint32_t>(i);
+        frame_best_[best] = std::min(frame_best_[best], packed);
+    }
+
+    for (int i = 0; i < n_ref; ++i) {
+        const int j = reference_best_[i];
+        if (j < 0 || static_cast<int>(frame_best_[j] & 0xffffffffu) != i) continue;
+        matches.emplace_back(j, i, static_cast<float>(frame_best_[j] >> 32));
+    }
+}
@@ -0,0 +1,60 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// GuidedMatcher
+//
+// Matches reference descriptors only against frame keypoints near where
+// each reference keypoint is expected to appear (e.g. projected through the
+// previous frame's homography), instead of against the whole frame.
+//
+//   GuidedMatcher guided;
+//   perspectiveTransform(reference_pts, predicted, H_prev);
+//   guided.match(frame_kps, frame_desc, reference_desc, predicted, 24.f, matches);
+//
+// Design:
+//   - Frame keypoints are bucketed into a uniform grid of radius-sized
+//     cells (CSR layout, buffers reused across calls), so each reference
+//     keypoint visits at most 3 x 3 cells
+//   - Candidates are ranked by exact Hamming distance (HammingMatcher
+//     kernels); a reference keypoint keeps its best candidate if it is
+//     below max_distance and passes the ratio test against the runner-up
+//   - One-to-one: a frame keypoint claimed by several reference keypoints
+//     goes to the closest descriptor (ties to the lowest reference index)
+//   - Output follows ORBDetector's convention: queryIdx = frame keypoint,
+//     trainIdx = reference row
+// ─────────────────────────────────────────────────────────────────────────────
+
+class GuidedMatcher {
+public:
+    int   max_distance = 64;     // Hamming, 0..256 for ORB
+    float ratio        = 0.9f;   // best < ratio x second best (within radius)
+
+    // `predicted` holds one frame position per reference row; entries
+    // outside the frame simply find no candidates.
+    void match(const std::vector<cv::KeyPoint>& frame_keypoints,
+               const cv::Mat&                   frame_descriptors,
+               const cv::Mat&                   reference_descriptors,
+               const std::vector<cv::Point2f>&  predicted,
+               float                            radius,
+               std::vector<cv::DMatch>&         matches);
+
+private:
+    void build_grid(const std::vector<cv::KeyPoint>& keypoints, float cell);
+
+    cv::Point2f                origin_;
+    float                      cell_      = 1.f;
+    int                        grid_cols_ = 0;
+    int                        grid_rows_ = 0;
+    std::vector<int>           cell_start_;     // grid_cols_ * grid_rows_ + 1
+    std::vector<int>           cell_entries_;   // keypoint indices by cell
+
+    std::vector<int>           candidates_;
+    std::vector<int>           distances_;
+    std::vector<int>           reference_best_; // frame index per reference row
+    std::vector<std::uint64_t> frame_best_;     // (distance << 32 | reference row)
+};
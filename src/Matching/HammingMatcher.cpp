@@ -0,0 +1,349 @@
+#include "Matching/HammingMatcher.h"
+
+#include <algorithm>
+#include <cstring>
+#include <limits>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__i386__)) && (defined(__GNUC__) || defined(__clang__))
+#define HAMMING_X86_DISPATCH 1
+#include <immintrin.h>
+#endif
+
+namespace {
+
+// Hamming distance from one query row to `n` train rows `step` bytes apart.
+using DistanceKernel = void (*)(const std::uint8_t* query,
+                                const std::uint8_t* train,
+                                std::size_t         step,
+                                int                 n,
+                                int                 bytes,
+                                int*                out);
+
+// ── Portable ─────────────────────────────────────────────────────────────────
+
+void distances_scalar(const std::uint8_t* query, const std::uint8_t* train,
+                      std::size_t step, int n, int bytes, int* out)
+{
+    const int words = bytes / 8;
+    for (int j = 0; j < n; ++j) {
+        const std::uint8_t* t = train + j * step;
+        int d = 0;
+        for (int w = 0; w < words; ++w) {
+            std::uint64_t a, b;
+            std::memcpy(&a, query + 8 * w, 8);
+            std::memcpy(&b, t + 8 * w, 8);
+            d += __builtin_popcountll(a ^ b);
+        }
+        for (int i = words * 8; i < bytes; ++i) {
+            d += __builtin_popcount(static_cast<unsigned>(query[i] ^ t[i]));
+        }
+        out[j] = d;
+    }
+}
+
+#ifdef HAMMING_X86_DISPATCH
+
+// ── AVX2 ─────────────────────────────────────────────────────────────────────
+// No vector popcount before AVX-512: look up each nibble's bit count with
+// vpshufb, accumulate per byte (≤ 8 per 32-byte chunk, so up to 31 chunks fit
+// in a byte), then horizontally add with vpsadbw.
+
+__attribute__((target("avx2")))
+void distances_avx2(const std::uint8_t* query, const std::uint8_t* train,
+                    std::size_t step, int n, int bytes, int* out)
+{
+    const __m256i lut = _mm256_setr_epi8(0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4,
+                                         0, 1, 1, 2, 1, 2, 2, 3, 1, 2, 2, 3, 2, 3, 3, 4);
+    const __m256i low  = _mm256_set1_epi8(0x0f);
+    const __m256i zero = _mm256_setzero_si256();
+    const int chunks = bytes / 32;
+
+    for (int j = 0; j < n; ++j) {
+        const std::uint8_t* t = train + j * step;
+        __m256i acc = zero;
+        for (int c = 0; c < chunks; ++c) {
+            const __m256i q = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(query + 32 * c));
+            const __m256i x = _mm256_xor_si256(
+                q, _mm256_loadu_si256(reinterpret_cast<const __m256i*>(t + 32 * c)));
+            const __m256i lo = _mm256_shuffle_epi8(lut, _mm256_and_si256(x, low));
+            const __m256i hi = _mm256_shuffle_epi8(lut, _mm256_and_si256(_mm256_srli_epi16(x, 4), low));
+            acc = _mm256_add_epi8(acc, _mm256_add_epi8(lo, hi));
+        }
+        const __m256i sums = _mm256_sad_epu8(acc, zero);
+        const __m128i s    = _mm_add_epi64(_mm256_castsi256_si128(sums),
+                                           _mm256_extracti128_si256(sums, 1));
+        out[j] = static_cast<int>(_mm_cvtsi128_si64(s) + _mm_extract_epi64(s, 1));
+    }
+}
+
+// ── AVX-512 VPOPCNTDQ ────────────────────────────────────────────────────────
+// 32-byte rows are paired so each 512-bit popcount covers two train rows.
+// Halves are assembled with zero-masked broadcasts and lanes summed through
+// memory: the cast/insert/reduce intrinsics carry undefined lanes that GCC
+// reports under -Wmaybe-uninitialized.
+
+__attribute__((target("avx512f,avx512vl,avx512vpopcntdq")))
+inline __m256i load256(const std::uint8_t* p)
+{
+    return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(p));
+}
+
+__attribute__((target("avx512f,avx512vl,avx512vpopcntdq")))
+inline int sum_lanes(__m256i v)
+{
+    alignas(32) std::uint64_t lanes[4];
+    _mm256_store_si256(reinterpret_cast<__m256i*>(lanes), v);
+    return static_cast<int>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+}
+
+__attribute__((target("avx512f,avx512vl,avx512vpopcntdq")))
+inline int sum_lanes(__m512i v)
+{
+    alignas(64) std::uint64_t lanes[8];
+    _mm512_store_si512(lanes, v);
+    return static_cast<int>(lanes[0] + lanes[1] + lanes[2] + lanes[3] +
+                            lanes[4] + lanes[5] + lanes[6] + lanes[7]);
+}
+
+__attribute__((target("avx512f,avx512vl,avx512vpopcntdq")))
+void distances_avx512(const std::uint8_t* query, const std::uint8_t* train,
+                      std::size_t step, int n, int bytes, int* out)
+{
+    if (bytes == 32) {
+        const __m256i q  = load256(query);
+        const __m512i qq = _mm512_maskz_broadcast_i64x4(0xff, q);
+        int j = 0;
+        for (; j + 2 <= n; j += 2) {
+            const __m512i tt = _mm512_mask_broadcast_i64x4(
+                _mm512_maskz_broadcast_i64x4(0x0f, load256(train + j * step)),
+                0xf0, load256(train + (j + 1) * step));
+            alignas(64) std::uint64_t lanes[8];
+            _mm512_store_si512(lanes, _mm512_popcnt_epi64(_mm512_xor_si512(qq, tt)));
+            out[j]     = static_cast<int>(lanes[0] + lanes[1] + lanes[2] + lanes[3]);
+            out[j + 1] = static_cast<int>(lanes[4] + lanes[5] + lanes[6] + lanes[7]);
+        }
+        if (j < n) {
+            out[j] = sum_lanes(_mm256_popcnt_epi64(
+                _mm256_xor_si256(q, load256(train + j * step))));
+        }
+        return;
+    }
+
+    for (int j = 0; j < n; ++j) {
+        const std::uint8_t* t = train + j * step;
+        __m512i acc = _mm512_setzero_si512();
+        int c = 0;
+        for (; c + 64 <= bytes; c += 64) {
+            const __m512i x = _mm512_xor_si512(_mm512_loadu_si512(query + c),
+                                               _mm512_loadu_si512(t + c));
+            acc = _mm512_add_epi64(acc, _mm512_popcnt_epi64(x));
+        }
+        if (c < bytes) {   // 32-byte tail
+            acc = _mm512_add_epi64(acc, _mm512_maskz_broadcast_i64x4(0x0f, _mm256_popcnt_epi64(
+                _mm256_xor_si256(load256(query + c), load256(t + c)))));
+        }
+        out[j] = sum_lanes(acc);
+    }
+}
+
+#endif // HAMMING_X86_DISPATCH
+
+// ── Dispatch ─────────────────────────────────────────────────────────────────
+
+enum class KernelKind { Scalar, AVX2, AVX512 };
+
+KernelKind best_kernel(int bytes)
+{
+#ifdef HAMMING_X86_DISPATCH
+    static const bool has_avx512 = __builtin_cpu_supports("avx512f") &&
+                                   __builtin_cpu_supports("avx512vl") &&
+                                   __builtin_cpu_supports("avx512vpopcntdq");
+    static const bool has_avx2   = __builtin_cpu_supports("avx2");
+
+    if (bytes % 32 == 0) {
+        if (has_avx512) return KernelKind::AVX512;
+        if (has_avx2 && bytes / 32 <= 31) return KernelKind::AVX2;
+    }
+#else
+    (void)bytes;
+#endif
+    return KernelKind::Scalar;
+}
+
+DistanceKernel kernel_for(KernelKind kind)
+{
+    switch (kind) {
+#ifdef HAMMING_X86_DISPATCH
+        case KernelKind::AVX512: return distances_avx512;
+        case KernelKind::AVX2:   return distances_avx2;
+#endif
+        default:                 return distances_scalar;
+    }
+}
+
+void check_descriptors(const cv::Mat& query, const cv::Mat& train)
+{
+    if (query.type() != CV_8U || train.type() != CV_8U || query.cols != train.cols) {
+        throw std::invalid_argument(
+            "[HammingMatcher] Descriptors must be CV_8U with equal row width.");
+    }
+}
+
+// Distances are computed into a buffer this many train rows at a time, so
+// it stays in L1 however large the train set is.
+constexpr int kTrainTile = 1024;
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Public API
+// ─────────────────────────────────────────────────────────────────────────────
+
+const char* HammingMatcher::kernel_name(int descriptor_bytes)
+{
+    switch (best_kernel(descriptor_bytes)) {
+        case KernelKind::AVX512: return "avx512-vpopcntdq";
+        case KernelKind::AVX2:   return "avx2";
+        default:                 return "scalar";
+    }
+}
+
+void HammingMatcher::distances(const std::uint8_t* query,
+                               const cv::Mat&      train,
+                               const int*          rows,
+                               int                 n,
+                               int*                out)
+{
+    const DistanceKernel kernel = kernel_for(best_kernel(train.cols));
+    for (int k = 0; k < n; ++k) {
+        kernel(query, train.ptr<std::uint8_t>(rows[k]), train.step[0], 1, train.cols, out + k);
+    }
+}
+
+void HammingMatcher::match(const cv::Mat&           query,
+                           const cv::Mat&           train,
+                           std::vector<cv::DMatch>& matches,
+                           bool                     cross_check) const
+{
+    matches.clear();
+    if (query.empty() || train.empty()) return;
+    check_descriptors(query, train);
+
+    std::vector<Top2>          top2;
+    std::vector<std::uint64_t> train_best;
+    search(query, train, top2, cross_check ? &train_best : nullptr);
+
+    matches.reserve(top2.size());
+    for (int i = 0; i < static_cast<int>(top2.size()); ++i) {
+        const Top2& t = top2[i];
+        if (cross_check &&
+            static_cast<std::uint32_t>(train_best[t.best_idx]) != static_cast<std::uint32_t>(i)) {
+            continue;
+        }
+        matches.emplace_back(i, t.best_idx, static_cast<float>(t.best_dist));
+    }
+}
+
+void HammingMatcher::ratio_match(const cv::Mat&           query,
+                                 const cv::Mat&           train,
+                                 float                    ratio,
+                                 std::vector<cv::DMatch>& matches) const
+{
+    matches.clear();
+    if (query.empty() || train.rows < 2) return;
+    check_descriptors(query, train);
+
+    std::vector<Top2> top2;
+    search(query, train, top2, nullptr);
+
+    for (int i = 0; i < static_cast<int>(top2.size()); ++i) {
+        const Top2& t = top2[i];
+        if (static_cast<float>(t.best_dist) < ratio * static_cast<float>(t.second_dist)) {
+            matches.emplace_back(i, t.best_idx, static_cast<float>(t.best_dist));
+        }
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// search
+// ─────────────────────────────────────────────────────────────────────────────
+
+void HammingMatcher::search(const cv::Mat&              query,
+                            const cv::Mat&              train,
+                            std::vector<Top2>&          top2,
+                            std::vector<std::uint64_t>* train_best) const
+{
+    const int n_query = query.rows;
+    const int n_train = train.rows;
+    const int bytes   = query.cols;
+
+    const DistanceKernel kernel = kernel_for(best_kernel(bytes));
+
+    top2.assign(n_query, Top2{});
+
+    // Fixed block count (not thread ids) so each block owns its per-train
+    // bests and the merge order — and therefore the result — is fixed.
+    const double pairs  = static_cast<double>(n_query) * n_train;
+    const int    blocks = pairs < min_parallel_pairs
+                              ? 1
+                              : std::max(1, std::min(cv::getNumThreads() * 4, n_query / 16));
+
+    constexpr std::uint64_t kNone = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::vector<std::uint64_t>> block_best;
+    if (train_best) {
+        block_best.assign(blocks, std::vector<std::uint64_t>(n_train, kNone));
+    }
+
+    auto run_block = [&](int b) {
+        const int begin = static_cast<int>(static_cast<long long>(n_query) * b / blocks);
+        const int end   = static_cast<int>(static_cast<long long>(n_query) * (b + 1) / blocks);
+        std::uint64_t* best_of_train = train_best ? block_best[b].data() : nullptr;
+
+        int dist[kTrainTile];
+        for (int i = begin; i < end; ++i) {
+            const std::uint8_t* q = query.ptr<std::uint8_t>(i);
+            Top2 t;
+            t.best_dist = t.second_dist = std::numeric_limits<int>::max();
+
+            for (int j0 = 0; j0 < n_train; j0 += kTrainTile) {
+                const int n = std::min(kTrainTile, n_train - j0);
+                kernel(q, train.ptr<std::uint8_t>(j0), train.step[0], n, bytes, dist);
+
+                for (int k = 0; k < n; ++k) {
+                    const int d = dist[k];
+                    if (d < t.best_dist) {
+                        t.second_dist = t.best_dist;
+                        t.best_dist   = d;
+                        t.best_idx    = j0 + k;
+                    } else if (d < t.second_dist) {
+                        t.second_dist = d;
+                    }
+                    if (best_of_train) {
+                        const std::uint64_t key = (static_cast<std::uint64_t>(d) << 32) |
+                                                  static_cast<std::uint32_t>(i);
+                        best_of_train[j0 + k] = std::min(best_of_train[j0 + k], key);
+                    }
+                }
+            }
+            top2[i] = t;
+        }
+    };
+
+    if (blocks == 1) {
+        run_block(0);
+    } else {
+        cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& r) {
+            for (int b = r.start; b < r.end; ++b) run_block(b);
+        });
+    }
+
+    if (train_best) {
+        *train_best = std::move(block_best[0]);
+        for (int b = 1; b < blocks; ++b) {
+            for (int j = 0; j < n_train; ++j) {
+                (*train_best)[j] = std::min((*train_best)[j], block_best[b][j]);
+            }
+        }
+    }
+}
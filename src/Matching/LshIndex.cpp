@@ -0,0 +1,301 @@
+#include "Matching/LshIndex.h"
+#include "Matching/HammingMatcher.h"
+
+#include <algorithm>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <stdexcept>
+#include <utility>
+
+namespace {
+
+std::uint32_t hash_key(std::uint32_t key, int shift)
+{
+    return (key * 0x9e3779b1u) >> shift;
+}
+
+// All key XOR masks flipping at most `max_flips` of `key_bits` bits, by
+// increasing number of flips ([0] == 0, the bucket itself).
+std::vector<std::uint32_t> make_probe_masks(int key_bits, int max_flips)
+{
+    std::vector<std::uint32_t> masks{ 0u };
+    std::vector<std::uint32_t> level{ 0u };
+    std::vector<int>           top{ -1 };     // highest flipped bit per mask
+
+    for (int flips = 1; flips <= max_flips; ++flips) {
+        std::vector<std::uint32_t> next;
+        std::vector<int>           next_top;
+        for (std::size_t i = 0; i < level.size(); ++i) {
+            for (int b = top[i] + 1; b < key_bits; ++b) {
+                next.push_back(level[i] | (1u << b));
+                next_top.push_back(b);
+            }
+        }
+        masks.insert(masks.end(), next.begin(), next.end());
+        level = std::move(next);
+        top   = std::move(next_top);
+    }
+    return masks;
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Build
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool LshIndex::build(const cv::Mat& descriptors, const LshParams& params)
+{
+    clear();
+
+    if (descriptors.empty() || descriptors.type() != CV_8U) {
+        std::cerr << "[LshIndex] Descriptors must be a non-empty CV_8U matrix.\n";
+        return false;
+    }
+    const int total_bits = descriptors.cols * 8;
+    if (params.tables < 1 || params.key_bits < 1 || params.key_bits > 24 ||
+        params.key_bits > total_bits || params.multi_probe < 0 || params.multi_probe > 3) {
+        std::cerr << "[LshIndex] Invalid parameters (tables " << params.tables
+                  << ", key_bits " << params.key_bits
+                  << ", multi_probe " << params.multi_probe << ").\n";
+        return false;
+    }
+
+    params_      = params;
+    descriptors_ = descriptors.clone();
+    probe_masks_ = make_probe_masks(params.key_bits, params.multi_probe);
+
+    const int rows = descriptors_.rows;
+    std::mt19937_64 rng(params.seed);
+
+    std::vector<int> all_bits(total_bits);
+    std::vector<std::pair<std::uint32_t, std::uint32_t>> keyed(rows);   // (key, row)
+
+    tables_.resize(params.tables);
+    for (Table& table : tables_) {
+        // Partial Fisher–Yates: key_bits distinct bit positions. Written out
+        // rather than std::shuffle so the index is identical across
+        // standard libraries.
+        for (int i = 0; i < total_bits; ++i) all_bits[i] = i;
+        for (int i = 0; i < params.key_bits; ++i) {
+            const int j = i + static_cast<int>(rng() % static_cast<std::uint64_t>(total_bits - i));
+            std::swap(all_bits[i], all_bits[j]);
+        }
+        table.bits.assign(all_bits.begin(), all_bits.begin() + params.key_bits);
+
+        for (int r = 0; r < rows; ++r) {
+            keyed[r] = { key_of(table, descriptors_.ptr<std::uint8_t>(r)),
+                         static_cast<std::uint32_t>(r) };
+        }
+        std::sort(keyed.begin(), keyed.end());
+
+        std::size_t unique = 0;
+        for (int r = 0; r < rows; ++r) {
+            if (r == 0 || keyed[r].first != keyed[r - 1].first) ++unique;
+        }
+
+        std::size_t capacity = 16;
+        while (capacity < unique * 2) capacity <<= 1;
+        table.shift = 32;
+        for (std::size_t c = capacity; c > 1; c >>= 1) --table.shift;
+
+        table.slots.assign(capacity, Slot{});
+        table.entries.resize(rows);
+
+        for (int r = 0; r < rows;) {
+            const std::uint32_t key = keyed[r].first;
+            const int begin = r;
+            for (; r < rows && keyed[r].first == key; ++r) {
+                table.entries[r] = keyed[r].second;
+            }
+
+            std::uint32_t s = hash_key(key, table.shift);
+            while (table.slots[s].key != kEmptyKey) s = (s + 1) & (capacity - 1);
+            table.slots[s] = { key, static_cast<std::uint32_t>(begin),
+                               static_cast<std::uint32_t>(r - begin) };
+        }
+    }
+
+    std::cout << "[LshIndex] Indexed " << rows << " descriptors: "
+              << params.tables << " tables x " << params.key_bits << " bits, "
+              << probe_masks_.size() << " probes per table\n";
+    return true;
+}
+
+void LshIndex::clear()
+{
+    descriptors_.release();
+    tables_.clear();
+    probe_masks_.clear();
+}
+
+std::uint32_t LshIndex::key_of(const Table& table, const std::uint8_t* row) const
+{
+    std::uint32_t key = 0;
+    for (std::size_t b = 0; b < table.bits.size(); ++b) {
+        const int bit = table.bits[b];
+        key |= static_cast<std::uint32_t>((row[bit >> 3] >> (bit & 7)) & 1u) << b;
+    }
+    return key;
+}
+
+const LshIndex::Slot* LshIndex::find(const Table& table, std::uint32_t key) const
+{
+    const std::size_t mask = table.slots.size() - 1;
+    for (std::uint32_t s = hash_key(key, table.shift);; s = (s + 1) & mask) {
+        const Slot& slot = table.slots[s];
+        if (slot.key == key)       return &slot;
+        if (slot.key == kEmptyKey) return nullptr;
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Query
+// ─────────────────────────────────────────────────────────────────────────────
+
+void LshIndex::match(const cv::Mat&           query,
+                     std::vector<cv::DMatch>& matches,
+                     bool                     cross_check) const
+{
+    matches.clear();
+    if (empty() || query.empty()) return;
+
+    std::vector<Top2>          top2;
+    std::vector<std::uint64_t> train_best;
+    search(query, top2, cross_check ? &train_best : nullptr);
+
+    for (int i = 0; i < static_cast<int>(top2.size()); ++i) {
+        const Top2& t = top2[i];
+        if (t.best_idx < 0) continue;
+        if (cross_check &&
+            static_cast<std::uint32_t>(train_best[t.best_idx]) != static_cast<std::uint32_t>(i)) {
+            continue;
+        }
+        matches.emplace_back(i, t.best_idx, static_cast<float>(t.best_dist));
+    }
+}
+
+void LshIndex::ratio_match(const cv::Mat&           query,
+                           float                    ratio,
+                           std::vector<cv::DMatch>& matches) const
+{
+    matches.clear();
+    if (empty() || query.empty()) return;
+
+    std::vector<Top2> top2;
+    search(query, top2, nullptr);
+
+    for (int i = 0; i < static_cast<int>(top2.size()); ++i) {
+        const Top2& t = top2[i];
+        if (t.best_idx < 0 || t.second_dist == std::numeric_limits<int>::max()) continue;
+        if (static_cast<float>(t.best_dist) < ratio * static_cast<float>(t.second_dist)) {
+            matches.emplace_back(i, t.best_idx, static_cast<float>(t.best_dist));
+        }
+    }
+}
+
+void LshIndex::search(const cv::Mat&              query,
+                      std::vector<Top2>&          top2,
+                      std::vector<std::uint64_t>* train_best) const
+{
+    if (query.type() != CV_8U || query.cols != descriptors_.cols) {
+        throw std::invalid_argument(
+            "[LshIndex] Query descriptors must be CV_8U with the indexed row width.");
+    }
+
+    const int n_query = query.rows;
+    const int n_train = descriptors_.rows;
+    top2.assign(n_query, Top2{});
+
+    // Same fixed-block scheme as HammingMatcher: results do not depend on
+    // the thread count.
+    const int blocks = n_query < min_parallel_queries
+                           ? 1
+                           : std::max(1, std::min(cv::getNumThreads() * 4, n_query / 64));
+
+    constexpr std::uint64_t kNone = std::numeric_limits<std::uint64_t>::max();
+    std::vector<std::vector<std::uint64_t>> block_best;
+    if (train_best) {
+        block_best.assign(blocks, std::vector<std::uint64_t>(n_train, kNone));
+    }
+
+    auto run_block = [&](int b) {
+        const int begin = static_cast<int>(static_cast<long long>(n_query) * b / blocks);
+        const int end   = static_cast<int>(static_cast<long long>(n_query) * (b + 1) / blocks);
+        std::uint64_t* best_of_train = train_best ? block_best[b].data() : nullptr;
+
+        // Visited stamps de-duplicate candidates found in several tables.
+        std::vector<std::uint32_t> stamp(n_train, 0);
+        std::uint32_t              generation = 0;
+        std::vector<int>           candidates;
+        std::vector<int>           dist;
+        candidates.reserve(256);
+
+        for (int i = begin; i < end; ++i) {
+            const std::uint8_t* q = query.ptr<std::uint8_t>(i);
+            ++generation;
+            candidates.clear();
+
+            for (const Table& table : tables_) {
+                const std::uint32_t key = key_of(table, q);
+                for (std::uint32_t mask : probe_masks_) {
+                    const Slot* slot = find(table, key ^ mask);
+                    if (!slot) continue;
+                    for (std::uint32_t e = slot->begin; e < slot->begin + slot->count; ++e) {
+                        const std::uint32_t row = table.entries[e];
+                        if (stamp[row] != generation) {
+                            stamp[row] = generation;
+                            candidates.push_back(static_cast<int>(row));
+                        }
+                    }
+                }
+            }
+
+            Top2 t;
+            t.best_dist = t.second_dist = std::numeric_limits<int>::max();
+            if (!candidates.empty()) {
+                // Ascending row order keeps ties on the lowest index.
+                std::sort(candidates.begin(), candidates.end());
+                dist.resize(candidates.size());
+                HammingMatcher::distances(q, descriptors_, candidates.data(),
+                                          static_cast<int>(candidates.size()), dist.data());
+
+                for (std::size_t k = 0; k < candidates.size(); ++k) {
+                    const int d = dist[k];
+                    const int j = candidates[k];
+                    if (d < t.best_dist) {
+                        t.second_dist = t.best_dist;
+                        t.best_dist   = d;
+                        t.best_idx    = j;
+                    } else if (d < t.second_dist) {
+                        t.second_dist = d;
+                    }
+                    if (best_of_train) {
+                        const std::uint64_t key = (static_cast<std::uint64_t>(d) << 32) |
+                                                  static_cast<std::uint32_t>(i);
+                        best_of_train[j] = std::min(best_of_train[j], key);
+                    }
+                }
+            }
+            top2[i] = t;
+        }
+    };
+
+    if (blocks == 1) {
+        run_block(0);
+    } else {
+        cv::parallel_for_(cv::Range(0, blocks), [&](const cv::Range& r) {
+            for (int b = r.start; b < r.end; ++b) run_block(b);
+        });
+    }
+
+    if (train_best) {
+        *train_best = std::move(block_best[0]);
+        for (int b = 1; b < blocks; ++b) {
+            for (int j = 0; j < n_train; ++j) {
+                (*train_best)[j] = std::min((*train_best)[j], block_best[b][j]);
+            }
+        }
+    }
+}
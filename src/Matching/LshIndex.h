@@ -0,0 +1,109 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstdint>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// LshIndex
+//
+// Approximate nearest-neighbour index over binary descriptors, built once
+// (e.g. from the reference image at init()) and queried every frame.
+//
+//   LshIndex index;
+//   index.build(reference_desc);                       // default LshParams
+//   index.match(frame_desc, matches);                  // cross-checked
+//   index.ratio_match(frame_desc, 0.75f, matches);     // Lowe ratio
+//
+// Design:
+//   - Bit-sampling LSH: each of `tables` hash tables keys a descriptor by
+//     `key_bits` bits picked at random (fixed seed, so the index is the same
+//     on every run). Near descriptors agree on most bits, so they collide
+//     in at least one table with high probability
+//   - Multi-probe: a query also visits the buckets whose key differs from
+//     its own in up to `multi_probe` bits, buying recall without more tables
+//   - Candidates from all tables are de-duplicated and ranked by exact
+//     Hamming distance (HammingMatcher kernels), so returned distances are
+//     exact — only the search is approximate
+//   - Buckets are stored CSR-style (one index array per table) behind an
+//     open-addressing key → bucket table; nothing is allocated per query
+//     except the output
+//
+// Recall / speed: more tables or a higher multi_probe raise recall; more
+// key_bits make buckets smaller (faster) but lower recall. The defaults
+// (12 tables, 16 bits, 1-bit probes) still find the true neighbour of a
+// descriptor with ~10% of its bits flipped, at 204 bucket lookups per query;
+// FLANN's usual 20 bits / 2-bit probes costs 2532 for no recall gain here.
+// For a few hundred reference descriptors brute force is still cheaper —
+// the index pays off from a few thousand.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct LshParams {
+    int           tables      = 12;
+    int           key_bits    = 16;     // 1..24
+    int           multi_probe = 1;      // 0..3 flipped key bits per probe
+    std::uint64_t seed        = 0x1f2e3d4c5b6a7988ULL;
+};
+
+class LshIndex {
+public:
+    // Queries per call below which matching stays on the calling thread.
+    int min_parallel_queries = 256;
+
+    // Index `descriptors` (CV_8U rows, copied). Returns false on bad input.
+    bool build(const cv::Mat& descriptors, const LshParams& params = LshParams());
+    void clear();
+
+    bool           empty()       const { return descriptors_.empty(); }
+    int            size()        const { return descriptors_.rows; }
+    const LshParams& params()    const { return params_; }
+    const cv::Mat& descriptors() const { return descriptors_; }
+
+    // Approximate nearest indexed row for every query row (queryIdx →
+    // trainIdx = indexed row). With cross_check only pairs that are also
+    // the best query for their indexed row are kept.
+    void match(const cv::Mat&           query,
+               std::vector<cv::DMatch>& matches,
+               bool                     cross_check = true) const;
+
+    // Nearest candidate per query row, kept if below `ratio` × the second
+    // nearest candidate. Queries with fewer than two candidates are dropped.
+    void ratio_match(const cv::Mat&           query,
+                     float                    ratio,
+                     std::vector<cv::DMatch>& matches) const;
+
+private:
+    struct Slot {
+        std::uint32_t key   = kEmptyKey;
+        std::uint32_t begin = 0;     // into Table::entries
+        std::uint32_t count = 0;
+    };
+
+    struct Table {
+        std::vector<int>           bits;        // sampled descriptor bit positions
+        std::vector<Slot>          slots;       // open addressing, power-of-two size
+        int                        shift = 32;  // hash → slot: 32 - log2(slots)
+        std::vector<std::uint32_t> entries;     // row indices grouped by key
+    };
+
+    struct Top2 {
+        int best_dist   = 0;
+        int best_idx    = -1;
+        int second_dist = 0;
+    };
+
+    static constexpr std::uint32_t kEmptyKey = 0xffffffffu;
+
+    std::uint32_t key_of(const Table& table, const std::uint8_t* row) const;
+    const Slot*   find(const Table& table, std::uint32_t key) const;
+
+    void search(const cv::Mat&              query,
+                std::vector<Top2>&          top2,
+                std::vector<std::uint64_t>* train_best) const;
+
+    LshParams                  params_;
+    cv::Mat                    descriptors_;
+    std::vector<Table>         tables_;
+    std::vector<std::uint32_t> probe_masks_;    // key XOR masks, [0] == 0
+};
@@ -0,0 +1,91 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// SpscQueue
+//
+// Bounded lock-free single-producer / single-consumer ring buffer used to
+// connect pipeline stages.
+//
+// Design:
+//   - Exactly one thread may call try_push()/close(), exactly one other
+//     thread may call try_pop()
+//   - One slot is kept empty so head == tail always means "empty"
+//   - head_/tail_ live on separate cache lines to avoid false sharing
+//     between the producer and consumer cores
+//   - close() marks end-of-stream; the consumer drains remaining items and
+//     then sees is_drained() == true
+// ─────────────────────────────────────────────────────────────────────────────
+
+template <typename T>
+class SpscQueue {
+public:
+    explicit SpscQueue(std::size_t capacity)
+        : slots_(capacity + 1) {}
+
+    SpscQueue(const SpscQueue&)            = delete;
+    SpscQueue& operator=(const SpscQueue&) = delete;
+
+    // Producer side. Returns false (and leaves item untouched) when full.
+    bool try_push(T&& item)
+    {
+        const std::size_t tail = tail_.load(std::memory_order_relaxed);
+        const std::size_t next = advance(tail);
+        if (next == head_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        slots_[tail] = std::move(item);
+        tail_.store(next, std::memory_order_release);
+        return true;
+    }
+
+    // Consumer side. Returns false when empty.
+    bool try_pop(T& out)
+    {
+        const std::size_t head = head_.load(std::memory_order_relaxed);
+        if (head == tail_.load(std::memory_order_acquire)) {
+            return false;
+        }
+        out = std::move(slots_[head]);
+        slots_[head] = T{};     // release anything the slot still references
+        head_.store(advance(head), std::memory_order_release);
+        return true;
+    }
+
+    // Producer side: no more items will be pushed.
+    void close() { closed_.store(true, std::memory_order_release); }
+
+    // Consumer side: closed and nothing left to pop.
+    bool is_drained() const
+    {
+        return closed_.load(std::memory_order_acquire) &&
+               head_.load(std::memory_order_relaxed) ==
+                   tail_.load(std::memory_order_acquire);
+    }
+
+    // Approximate when called concurrently with push/pop.
+    std::size_t size() const
+    {
+        const std::size_t head = head_.load(std::memory_order_acquire);
+        const std::size_t tail = tail_.load(std::memory_order_acquire);
+        return tail >= head ? tail - head : tail + slots_.size() - head;
+    }
+
+    std::size_t capacity() const { return slots_.size() - 1; }
+
+private:
+    std::size_t advance(std::size_t i) const
+    {
+        return (i + 1 == slots_.size()) ? 0 : i + 1;
+    }
+
+    std::vector<T> slots_;
+
+    alignas(64) std::atomic<std::size_t> head_{ 0 };   // next slot to pop
+    alignas(64) std::atomic<std::size_t> tail_{ 0 };   // next slot to fill
+    std::atomic<bool>                    closed_{ false };
+};
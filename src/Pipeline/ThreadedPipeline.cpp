@@ -0,0 +1,416 @@
+#include "Pipeline/ThreadedPipeline.h"
+#include "Telemetry/Profiler.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <chrono>
+#include <deque>
+#include <iomanip>
+#include <iostream>
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+constexpr int kSpinIterations  = 64;
+constexpr int kYieldIterations = 64;
+constexpr auto kSleepInterval  = std::chrono::microseconds(100);
+
+// Escalating wait used while a queue is empty/full.
+void backoff(int attempt)
+{
+    if (attempt < kSpinIterations) {
+        return;                                  // busy spin
+    }
+    if (attempt < kSpinIterations + kYieldIterations) {
+        std::this_thread::yield();
+        return;
+    }
+    std::this_thread::sleep_for(kSleepInterval);
+}
+
+// Saturates once the backoff has reached its sleeping phase.
+int next_attempt(int attempt)
+{
+    return attempt < kSpinIterations + kYieldIterations ? attempt + 1 : attempt;
+}
+
+std::uint64_t elapsed_ns(Clock::time_point since)
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - since).count());
+}
+
+const char* stage_name(std::size_t stage)
+{
+    static const char* names[] = { "capture", "detect", "stabilize", "crop", "output" };
+    return names[stage];
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Construction
+// ─────────────────────────────────────────────────────────────────────────────
+
+ThreadedPipeline::ThreadedPipeline(std::unique_ptr<IVideoInputStream> input,
+                                   std::unique_ptr<IFeatureDetector>  detector,
+                                   std::unique_ptr<IVideoStabilizer>  stabilizer,
+                                   std::unique_ptr<IFrameCropper>     cropper,
+                                   Options                            opts)
+    : input_(std::move(input))
+    , detector_(std::move(detector))
+    , stabilizer_(std::move(stabilizer))
+    , cropper_(std::move(cropper))
+    , opts_(opts)
+{
+}
+
+ThreadedPipeline::~ThreadedPipeline()
+{
+    stop();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Public API
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool ThreadedPipeline::init(const Config& cfg, FrameCallback on_frame)
+{
+    if (running_.load()) {
+        std::cerr << "[ThreadedPipeline] Cannot init while running.\n";
+        return false;
+    }
+    if (!input_ || !detector_ || !stabilizer_ || !cropper_) {
+        std::cerr << "[ThreadedPipeline] Missing pipeline component.\n";
+        return false;
+    }
+    if (!on_frame) {
+        std::cerr << "[ThreadedPipeline] No frame callback given.\n";
+        return false;
+    }
+
+    on_frame_ = std::move(on_frame);
+    stop_requested_.store(false);
+
+    for (StageStats& st : stats_) {
+        st.frames.store(0);
+        st.input_stalls.store(0);
+        st.output_stalls.store(0);
+        st.input_wait_ns.store(0);
+        st.output_wait_ns.store(0);
+    }
+
+    // ── Queues (depth 0 would deadlock — clamp to 1) ─────────────────────────
+    auto depth = [](std::size_t d) { return d == 0 ? std::size_t{ 1 } : d; };
+    capture_q_   = std::make_unique<SpscQueue<RawFrame>>(depth(opts_.capture_queue_depth));
+    detect_q_    = std::make_unique<SpscQueue<DetectedFrame>>(depth(opts_.detect_queue_depth));
+    stabilize_q_ = std::make_unique<SpscQueue<StabilizedItem>>(depth(opts_.stabilize_queue_depth));
+    output_q_    = std::make_unique<SpscQueue<CroppedFrame>>(depth(opts_.output_queue_depth));
+
+    // ── Components ───────────────────────────────────────────────────────────
+    stabilizer_->set_deferred_warp(opts_.fuse_stabilize_crop);
+
+    if (!detector_->init(cfg.detector_config,
+                         cfg.detector_weights,
+                         cfg.detector_reference)) {
+        std::cerr << "[ThreadedPipeline] Detector init failed.\n";
+        return false;
+    }
+    detector_->warmup();
+    if (!stabilizer_->init(cfg.stabilizer_config, cfg.stabilizer_weights)) {
+        std::cerr << "[ThreadedPipeline] Stabilizer init failed.\n";
+        return false;
+    }
+    if (!input_->start(cfg.gst_pipeline_desc)) {
+        std::cerr << "[ThreadedPipeline] Failed to start input stream.\n";
+        return false;
+    }
+
+    initialized_.store(true);
+    std::cout << "[ThreadedPipeline] Initialized. Queue depths: "
+              << capture_q_->capacity()   << " / "
+              << detect_q_->capacity()    << " / "
+              << stabilize_q_->capacity() << " / "
+              << output_q_->capacity()    << "\n";
+    return true;
+}
+
+void ThreadedPipeline::run()
+{
+    if (!initialized_.load()) {
+        std::cerr << "[ThreadedPipeline] run() called before init().\n";
+        return;
+    }
+    if (running_.exchange(true)) {
+        std::cerr << "[ThreadedPipeline] Already running.\n";
+        return;
+    }
+
+    threads_.emplace_back(&ThreadedPipeline::capture_loop,   this);
+    threads_.emplace_back(&ThreadedPipeline::detect_loop,    this);
+    threads_.emplace_back(&ThreadedPipeline::stabilize_loop, this);
+    threads_.emplace_back(&ThreadedPipeline::crop_loop,      this);
+
+    output_loop();
+
+    // The output loop only exits on EOS or stop(); make sure every upstream
+    // stage unblocks before joining. The capture thread may be blocked inside
+    // the source (stalled or live stream) rather than on a queue.
+    stop_requested_.store(true);
+    input_->interrupt();
+    for (auto& t : threads_) {
+        if (t.joinable()) t.join();
+    }
+    threads_.clear();
+
+    input_->stop();
+    initialized_.store(false);
+    running_.store(false);
+
+    print_stats(std::cout);
+}
+
+void ThreadedPipeline::stop()
+{
+    // Only touches an atomic — safe to call from a signal handler.
+    stop_requested_.store(true);
+}
+
+bool ThreadedPipeline::is_running() const
+{
+    return running_.load();
+}
+
+void ThreadedPipeline::print_stats(std::ostream& os) const
+{
+    os << "[ThreadedPipeline] Stage stats:\n";
+    for (std::size_t s = 0; s < StageCount; ++s) {
+        const StageStats& st = stats_[s];
+        os << "  " << std::left << std::setw(10) << stage_name(s) << std::right
+           << " frames: "       << std::setw(7) << st.frames.load()
+           << " | in-stalls: "  << std::setw(7) << st.input_stalls.load()
+           << " (" << st.input_wait_ns.load() / 1000000 << " ms)"
+           << " | out-stalls: " << std::setw(7) << st.output_stalls.load()
+           << " (" << st.output_wait_ns.load() / 1000000 << " ms)\n";
+    }
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Queue helpers
+// ─────────────────────────────────────────────────────────────────────────────
+
+template <typename T>
+bool ThreadedPipeline::push_blocking(SpscQueue<T>& queue, T&& item, Stage stage)
+{
+    if (queue.try_push(std::move(item))) {
+        return true;
+    }
+
+    StageStats& st = stats_[stage];
+    st.output_stalls.fetch_add(1, std::memory_order_relaxed);
+    const auto since = Clock::now();
+
+    for (int attempt = 0; !stop_requested_.load(std::memory_order_relaxed);
+         attempt = next_attempt(attempt)) {
+        backoff(attempt);
+        if (queue.try_push(std::move(item))) {
+            st.output_wait_ns.fetch_add(elapsed_ns(since), std::memory_order_relaxed);
+            return true;
+        }
+    }
+    st.output_wait_ns.fetch_add(elapsed_ns(since), std::memory_order_relaxed);
+    return false;
+}
+
+template <typename T>
+bool ThreadedPipeline::pop_blocking(SpscQueue<T>& queue, T& out, Stage stage)
+{
+    if (queue.try_pop(out)) {
+        return true;
+    }
+
+    StageStats& st = stats_[stage];
+    st.input_stalls.fetch_add(1, std::memory_order_relaxed);
+    const auto since = Clock::now();
+
+    for (int attempt = 0; !stop_requested_.load(std::memory_order_relaxed);
+         attempt = next_attempt(attempt)) {
+        if (queue.try_pop(out)) {
+            st.input_wait_ns.fetch_add(elapsed_ns(since), std::memory_order_relaxed);
+            return true;
+        }
+        if (queue.is_drained()) {
+            break;                                   // upstream hit EOS
+        }
+        backoff(attempt);
+    }
+    st.input_wait_ns.fetch_add(elapsed_ns(since), std::memory_order_relaxed);
+    return false;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Stage loops
+// ─────────────────────────────────────────────────────────────────────────────
+
+void ThreadedPipeline::capture_loop()
+{
+    Profiler::instance().set_thread_name("capture");
+
+    while (!stop_requested_.load()) {
+        std::optional<RawFrame> maybe_frame;
+        {
+            PROFILE_SCOPE("capture");
+            maybe_frame = input_->pull_frame();
+        }
+        if (!maybe_frame.has_value()) {
+            std::cout << "[ThreadedPipeline] Stream ended (EOS or error).\n";
+            break;
+        }
+        stats_[Capture].frames.fetch_add(1, std::memory_order_relaxed);
+        if (!push_blocking(*capture_q_, std::move(*maybe_frame), Capture)) {
+            break;
+        }
+    }
+    capture_q_->close();
+}
+
+void ThreadedPipeline::detect_loop()
+{
+    Profiler::instance().set_thread_name("detect");
+
+    const int every_n = opts_.detect_every_n > 0 ? opts_.detect_every_n : 1;
+    std::size_t frame_idx = 0;
+
+    RawFrame raw;
+    while (pop_blocking(*capture_q_, raw, Detect)) {
+        DetectedFrame item;
+        if (frame_idx % every_n == 0) {
+            PROFILE_SCOPE("detect");
+            item.detection = detector_->detect(raw);
+        } else {
+            item.detection.valid = false;
+        }
+        item.frame = std::move(raw);
+        ++frame_idx;
+
+        stats_[Detect].frames.fetch_add(1, std::memory_order_relaxed);
+        if (!push_blocking(*detect_q_, std::move(item), Detect)) {
+            break;
+        }
+    }
+    detect_q_->close();
+}
+
+void ThreadedPipeline::stabilize_loop()
+{
+    Profiler::instance().set_thread_name("stabilize");
+
+    // A lookahead stabilizer emits frames late, so remember whether each
+    // input carried a detection until its output comes back (matched by pts).
+    struct InFlight {
+        std::int64_t pts_ns;
+        bool         valid;
+        bool         predicted;
+    };
+    std::deque<InFlight> in_flight;
+
+    auto forward = [&](StabilizedFrame&& frame) {
+        StabilizedItem item;
+        while (!in_flight.empty() && in_flight.front().pts_ns != frame.pts_ns) {
+            in_flight.pop_front();
+        }
+        if (!in_flight.empty()) {
+            item.detection_valid     = in_flight.front().valid;
+            item.detection_predicted = in_flight.front().predicted;
+            in_flight.pop_front();
+        }
+        item.frame = std::move(frame);
+
+        stats_[Stabilize].frames.fetch_add(1, std::memory_order_relaxed);
+        return push_blocking(*stabilize_q_, std::move(item), Stabilize);
+    };
+
+    bool ok = true;
+    DetectedFrame in;
+    while (ok && pop_blocking(*detect_q_, in, Stabilize)) {
+        in_flight.push_back({ in.frame.pts_ns, in.detection.valid, in.detection.predicted });
+
+        StabilizedFrame out;
+        {
+            PROFILE_SCOPE("stabilize");
+            out = stabilizer_->stabilize(in.frame, in.detection);
+        }
+        in = DetectedFrame{};                // drop our reference to the raw frame
+
+        if (out.ready) {
+            ok = forward(std::move(out));
+        }
+    }
+
+    // EOS: emit whatever the stabilizer is still holding back.
+    {
+        PROFILE_SCOPE("stabilize_flush");
+        stabilizer_->flush();
+    }
+    StabilizedFrame tail;
+    while (ok && !stop_requested_.load() && stabilizer_->drain(tail)) {
+        ok = forward(std::move(tail));
+    }
+    stabilize_q_->close();
+}
+
+void ThreadedPipeline::crop_loop()
+{
+    Profiler::instance().set_thread_name("crop");
+
+    StabilizedItem in;
+    while (pop_blocking(*stabilize_q_, in, Crop)) {
+        CroppedFrame cropped;
+        {
+            PROFILE_SCOPE("crop");
+            cropped = cropper_->crop(in.frame,
+                                     opts_.output_width,
+                                     opts_.output_height);
+
+            if (opts_.draw_detection && in.detection_valid) {
+                // Drawn on the small output instead of the source frame, which
+                // may be a read-only view of the capture buffer. A prediction
+                // from the motion model (no measurement this frame) is drawn
+                // as a thin yellow circle instead of the green one.
+                const cv::Point2f local = in.frame.suggested_center -
+                                          cv::Point2f(cropped.src_roi.tl());
+                if (in.detection_predicted) {
+                    cv::circle(cropped.data, static_cast<cv::Point>(local),
+                               12, { 0, 255, 255 }, 1);
+                } else {
+                    cv::circle(cropped.data, static_cast<cv::Point>(local),
+                               12, { 0, 255, 0 }, 2);
+                }
+            }
+        }
+        in = StabilizedItem{};
+
+        stats_[Crop].frames.fetch_add(1, std::memory_order_relaxed);
+        if (!push_blocking(*output_q_, std::move(cropped), Crop)) {
+            break;
+        }
+    }
+    output_q_->close();
+}
+
+void ThreadedPipeline::output_loop()
+{
+    Profiler::instance().set_thread_name("output");
+
+    CroppedFrame cropped;
+    while (pop_blocking(*output_q_, cropped, Output)) {
+        PROFILE_SCOPE("write");
+        on_frame_(cropped);
+        stats_[Output].frames.fetch_add(1, std::memory_order_relaxed);
+    }
+}
@@ -0,0 +1,134 @@
+#pragma once
+
+#include "interfaces.h"
+#include "Pipeline/SpscQueue.h"
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ThreadedPipeline
+//
+// Implementation of IPipelineOrchestrator that runs every stage on its own
+// thread, connected by bounded lock-free SPSC queues:
+//
+//   capture ─▶ detect ─▶ stabilize ─▶ crop ─▶ on_frame (caller of run())
+//
+// Design:
+//   - Each stage owns exactly one component, so the stateful detector and
+//     stabilizer still see frames strictly in order
+//   - Steady-state frame time becomes that of the slowest stage rather than
+//     the sum of all stages
+//   - The FrameCallback runs on the thread that called run(), so window
+//     outputs (cv::imshow) stay on the main thread
+//   - EOS travels downstream by closing each queue once its producer is done;
+//     stop() makes every stage bail out at its next queue operation
+//   - Per-stage counters record how often (and how long) a stage waited on
+//     an empty input or a full output queue
+//   - With fuse_stabilize_crop the stabilize stage hands over the unwarped
+//     frame plus its warp, and the crop stage warps only the output region
+// ─────────────────────────────────────────────────────────────────────────────
+
+class ThreadedPipeline : public IPipelineOrchestrator {
+public:
+    struct Options {
+        std::size_t capture_queue_depth   = 4;   // capture   → detect
+        std::size_t detect_queue_depth    = 4;   // detect    → stabilize
+        std::size_t stabilize_queue_depth = 4;   // stabilize → crop
+        std::size_t output_queue_depth    = 4;   // crop      → on_frame
+
+        int  output_width   = 1920;
+        int  output_height  = 1080;
+        int  detect_every_n = 1;       // run the detector on every N-th frame
+        bool draw_detection = false;   // overlay the detected centre on output
+
+        // Stabilizer only computes the transform; the crop stage resamples
+        // the output ROI through it in one pass (no full-frame warp).
+        bool fuse_stabilize_crop = true;
+    };
+
+    enum Stage : std::size_t { Capture, Detect, Stabilize, Crop, Output, StageCount };
+
+    struct StageStats {
+        std::atomic<std::uint64_t> frames{ 0 };
+        std::atomic<std::uint64_t> input_stalls{ 0 };    // waits on empty input
+        std::atomic<std::uint64_t> output_stalls{ 0 };   // waits on full output
+        std::atomic<std::uint64_t> input_wait_ns{ 0 };
+        std::atomic<std::uint64_t> output_wait_ns{ 0 };
+    };
+
+    ThreadedPipeline(std::unique_ptr<IVideoInputStream> input,
+                     std::unique_ptr<IFeatureDetector>  detector,
+                     std::unique_ptr<IVideoStabilizer>  stabilizer,
+                     std::unique_ptr<IFrameCropper>     cropper,
+                     Options                            opts);
+    ~ThreadedPipeline() override;
+
+    // ── IPipelineOrchestrator ────────────────────────────────────────────────
+
+    bool init(const Config& cfg, FrameCallback on_frame) override;
+    void run() override;
+    void stop() override;
+    bool is_running() const override;
+
+    // ── Diagnostics ──────────────────────────────────────────────────────────
+
+    const StageStats& stats(Stage stage) const { return stats_[stage]; }
+    void              print_stats(std::ostream& os) const;
+
+private:
+    // Frame plus the detection made on it (detect → stabilize).
+    struct DetectedFrame {
+        RawFrame        frame;
+        DetectionResult detection;
+    };
+
+    // Stabilized frame plus whether it carries a detection, and whether that
+    // is only a motion-model prediction (stabilize → crop).
+    struct StabilizedItem {
+        StabilizedFrame frame;
+        bool            detection_valid     = false;
+        bool            detection_predicted = false;
+    };
+
+    // ── Stage loops ──────────────────────────────────────────────────────────
+    void capture_loop();
+    void detect_loop();
+    void stabilize_loop();
+    void crop_loop();
+    void output_loop();
+
+    // ── Blocking queue helpers (spin → yield → sleep backoff) ────────────────
+    // Both return false when stop() was requested; pop also returns false at EOS.
+    template <typename T>
+    bool push_blocking(SpscQueue<T>& queue, T&& item, Stage stage);
+
+    template <typename T>
+    bool pop_blocking(SpscQueue<T>& queue, T& out, Stage stage);
+
+    // ── Components ───────────────────────────────────────────────────────────
+    std::unique_ptr<IVideoInputStream> input_;
+    std::unique_ptr<IFeatureDetector>  detector_;
+    std::unique_ptr<IVideoStabilizer>  stabilizer_;
+    std::unique_ptr<IFrameCropper>     cropper_;
+    FrameCallback                      on_frame_;
+    Options                            opts_;
+
+    // ── Inter-stage queues ───────────────────────────────────────────────────
+    std::unique_ptr<SpscQueue<RawFrame>>       capture_q_;
+    std::unique_ptr<SpscQueue<DetectedFrame>>  detect_q_;
+    std::unique_ptr<SpscQueue<StabilizedItem>> stabilize_q_;
+    std::unique_ptr<SpscQueue<CroppedFrame>>   output_q_;
+
+    std::vector<std::thread> threads_;
+    std::array<StageStats, StageCount> stats_;
+
+    std::atomic<bool> initialized_{ false };
+    std::atomic<bool> running_{ false };
+    std::atomic<bool> stop_requested_{ false };
+};
@@ -1,4 +1,6 @@
 #include "EdRansacStabilizer.h"
+#include "Common/FrameCache.h"
+#include "Common/ImageOps.h"
 
 #include <opencv2/imgproc.hpp>
 #include <opencv2/calib3d.hpp>
@@ -21,11 +23,11 @@ bool EDRansacStabilizer::init(const std::string& /*model_config*/,
         std::cout << "[EDRansacStabilizer] Using shared ORB model from ORBDetector.\n";
     }
 
-    // ORB uses binary descriptors → Hamming distance
-    matcher_ = cv::BFMatcher::create(cv::NORM_HAMMING, false);
-
     frame_idx_ = 0;
-    trajectory_.clear();
+    lookahead_ = static_cast<std::size_t>(std::max(0, lookahead));
+    reset_trajectory();
+    pending_.clear();
+    drained_.clear();
     prev_gray_.release();
     prev_kps_.clear();
     prev_desc_.release();
@@ -34,85 +36,93 @@ bool EDRansacStabilizer::init(const std::string& /*model_config*/,
               << "  Lowe ratio      : " << lowe_ratio            << "\n"
               << "  RANSAC thresh   : " << ransac_reproj_thresh  << " px\n"
               << "  ED threshold    : " << ed_threshold          << " px\n"
-              << "  Smooth radius   : " << smooth_radius         << " frames\n";
+              << "  Smooth radius   : " << smooth_radius         << " frames\n"
+              << "  Lookahead       : " << lookahead_            << " frames"
+              << (lookahead_ > 0 ? " (centred window)\n" : " (trailing window)\n");
 
     return true;
 }
 
-void EDRansacStabilizer::get_features(RawFrame&                  frame,
+void EDRansacStabilizer::get_features(const RawFrame&            frame,
                                        const cv::Mat&             gray,
                                        std::vector<cv::KeyPoint>& kps,
                                        cv::Mat&                   desc) const
 {
-    if (frame.features_computed) {
+    FrameCache& cache = frame.cache;
+    if (cache.features_computed) {
         // ORBDetector already ran on this frame — reuse its results
-        kps  = frame.keypoints;
-        desc = frame.descriptors;
+        kps  = cache.keypoints;
+        desc = cache.descriptors;
         return;
     }
 
     // Compute features ourselves using whichever ORB model is active
-    active_orb()->detectAndCompute(gray, cv::noArray(), kps, desc);
+    extractor_.detect_and_compute(active_orb(), gray, kps, desc);
 
     // Cache so that any later pipeline stage can also reuse them
-    frame.keypoints          = kps;
-    frame.descriptors        = desc;
-    frame.features_computed  = true;
+    cache.keypoints          = kps;
+    cache.descriptors        = desc;
+    cache.features_computed  = true;
 }
 
 StabilizedFrame EDRansacStabilizer::stabilize(const RawFrame&        frame,
                                                const DetectionResult& detection)
 {
-    // stabilize() receives a const ref from the interface but we need to write
-    // back cached features. We cast away const here intentionally — the frame
-    // data itself (pixels, pts) is never modified, only the feature cache.
-    RawFrame& mutable_frame = const_cast<RawFrame&>(frame);
+    const cv::Size size = image_size(frame.data, frame.format);
 
     StabilizedFrame out;
     out.pts_ns           = frame.pts_ns;
+    out.format           = frame.format;
     out.suggested_center = detection.valid
         ? detection.center
-        : cv::Point2f(frame.data.cols / 2.f, frame.data.rows / 2.f);
+        : cv::Point2f(size.width / 2.f, size.height / 2.f);
 
-    // ── Grayscale conversion ─────────────────────────────────────────────────
-    cv::Mat gray;
-    cv::cvtColor(frame.data, gray, cv::COLOR_BGR2GRAY);
+    // ── Grayscale (Y plane view for I420/Gray input) ─────────────────────────
+    const cv::Mat& gray = cached_gray(frame);
 
     // ── Extract / reuse features for current frame ───────────────────────────
     std::vector<cv::KeyPoint> curr_kps;
     cv::Mat curr_desc;
-    get_features(mutable_frame, gray, curr_kps, curr_desc);
+    get_features(frame, gray, curr_kps, curr_desc);
 
     // ── First frame: store state and pass through unchanged ──────────────────
     if (frame_idx_ == 0 || prev_gray_.empty()) {
-        trajectory_.push_back(cv::Mat::eye(3, 3, CV_64F));
+        push_trajectory(cv::Matx33d::eye());
         prev_gray_ = gray;
         prev_kps_  = curr_kps;
         prev_desc_ = curr_desc;
-        out.data   = frame.data.clone();
         ++frame_idx_;
+
+        if (lookahead_ > 0) {
+            pending_.push_back({ frame.data, frame.format, frame.pts_ns, detection });
+            out.ready = false;
+            return out;
+        }
+        out.data = frame.data.clone();
         return out;
     }
 
     // ── Match previous → current ─────────────────────────────────────────────
-    std::vector<std::vector<cv::DMatch>> knn_matches;
-    matcher_->knnMatch(prev_desc_, curr_desc, knn_matches, 2);
+    // Top-2 search with Lowe's ratio test fused in
+    std::vector<cv::DMatch> matches;
+    matcher_.ratio_match(prev_desc_, curr_desc, lowe_ratio, matches);
 
-    // Lowe's ratio test
     std::vector<cv::Point2f> pts_prev, pts_curr;
-    for (const auto& m : knn_matches) {
-        if (m.size() < 2) continue;
-        if (m[0].distance < lowe_ratio * m[1].distance) {
-            pts_prev.push_back(prev_kps_[m[0].queryIdx].pt);
-            pts_curr.push_back(curr_kps[m[0].trainIdx].pt);
-        }
+    std::vector<float>       distances;        // PROSAC ordering
+    pts_prev.reserve(matches.size());
+    pts_curr.reserve(matches.size());
+    distances.reserve(matches.size());
+    for (const auto& m : matches) {
+        pts_prev.push_back(prev_kps_[m.queryIdx].pt);
+        pts_curr.push_back(curr_kps[m.trainIdx].pt);
+        distances.push_back(m.distance);
     }
 
     // ── ED-RANSAC homography ─────────────────────────────────────────────────
     cv::Mat H_inter = cv::Mat::eye(3, 3, CV_64F);  // fallback: identity (no warp)
 
     if ((int)pts_prev.size() >= min_inliers) {
-        cv::Mat H = ed_ransac(pts_prev, pts_curr);
+        cv::Mat H = ed_ransac(pts_prev, pts_curr, distances);
         if (!H.empty()) {
             H_inter = H;
         } else {
@@ -127,35 +137,8 @@ StabilizedFrame EDRansacStabilizer::stabilize(const RawFrame&        frame,
 
     // ── Accumulate trajectory ────────────────────────────────────────────────
     // T[i] = H_inter(i-1→i) * T[i-1]   gives us frame 0 → frame i
-    cv::Mat T_curr = H_inter * trajectory_.back();
-    trajectory_.push_back(T_curr.clone());
-
-    // ── Smoothed trajectory ──────────────────────────────────────────────────
-    cv::Mat T_smooth = smooth_transform(frame_idx_);
-
-    // ── Correction warp: what we need to apply to the raw frame ─────────────
-    // warp = T_smooth * T_curr⁻¹
-    cv::Mat warp = T_smooth * T_curr.inv();
-
-    // ── Apply warp ───────────────────────────────────────────────────────────
-    cv::Mat stabilized;
-    cv::warpPerspective(frame.data, stabilized, warp,
-                        frame.data.size(),
-                        cv::INTER_LINEAR,
-                        cv::BORDER_REPLICATE);
-
-    // ── Transform suggested center through warp ──────────────────────────────
-    if (detection.valid) {
-        std::vector<cv::Point2f> center_in  = { detection.center };
-        std::vector<cv::Point2f> center_out;
-        cv::perspectiveTransform(center_in, center_out, warp);
-
-        float cx = std::max(0.f, std::min(center_out[0].x, (float)(frame.data.cols - 1)));
-        float cy = std::max(0.f, std::min(center_out[0].y, (float)(frame.data.rows - 1)));
-        out.suggested_center = { cx, cy };
-    }
-
-    out.data = stabilized;
+    const cv::Matx33d T_curr = cv::Matx33d(H_inter) * T_last_;
+    push_trajectory(T_curr);
 
     // ── Update previous-frame state ──────────────────────────────────────────
     // Note: we store the raw (un-warped) keypoints because the next frame's
@@ -168,39 +151,140 @@ StabilizedFrame EDRansacStabilizer::stabilize(const RawFrame&        frame,
     if (frame_idx_ % 30 == 0) {
         std::cout << "[EDRansacStabilizer] Frame " << frame_idx_
                   << " | raw matches: " << pts_prev.size()
-                  << " | cache hit: " << (frame.features_computed ? "yes" : "no")
+                  << " | cache hit: " << (frame.cache.features_computed ? "yes" : "no")
                   << "\n";
     }
 
     ++frame_idx_;
+
+    // ── Causal: correct the current frame against the trailing window ───────
+    if (lookahead_ == 0) {
+        return make_output({ frame.data, frame.format, frame.pts_ns, detection },
+                           smooth_transform(), T_curr);
+    }
+
+    // ── Lookahead: hold K frames, emit the one K behind with a centred window
+    pending_.push_back({ frame.data, frame.format, frame.pts_ns, detection });
+    if (pending_.size() <= lookahead_) {
+        out.ready = false;
+        return out;
+    }
+
+    const PendingFrame centre = std::move(pending_.front());
+    pending_.pop_front();
+    return make_output(centre, smooth_transform(), trajectory_back(lookahead_));
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// flush / drain
+//
+// At EOS the last (up to K) buffered frames have fewer than K successors,
+// so their window is truncated on the right: [c - K, newest].
+// ─────────────────────────────────────────────────────────────────────────────
+
+void EDRansacStabilizer::flush()
+{
+    while (!pending_.empty()) {
+        const std::size_t ahead = pending_.size() - 1;   // newer frames in the ring
+        const std::size_t span  = std::min(window_count_, lookahead_ + 1 + ahead);
+
+        cv::Matx33d sum = cv::Matx33d::zeros();
+        for (std::size_t n = 0; n < span; ++n) {
+            sum += trajectory_back(n);
+        }
+        const cv::Matx33d T_smooth = span > 0
+            ? sum * (1.0 / static_cast<double>(span))
+            : cv::Matx33d::eye();
+
+        drained_.push_back(make_output(pending_.front(), T_smooth,
+                                       trajectory_back(ahead)));
+        pending_.pop_front();
+    }
+}
+
+bool EDRansacStabilizer::drain(StabilizedFrame& out)
+{
+    if (drained_.empty()) return false;
+    out = std::move(drained_.front());
+    drained_.pop_front();
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// make_output
+//
+// Correction warp for a frame with cumulative transform T_frame:
+//   warp = T_smooth * T_frame⁻¹
+// ─────────────────────────────────────────────────────────────────────────────
+
+StabilizedFrame EDRansacStabilizer::make_output(const PendingFrame& f,
+                                                const cv::Matx33d&  T_smooth,
+                                                const cv::Matx33d&  T_frame) const
+{
+    const cv::Size    size = image_size(f.data, f.format);
+    const cv::Matx33d warp = T_smooth * T_frame.inv();
+
+    StabilizedFrame out;
+    out.pts_ns           = f.pts_ns;
+    out.format           = f.format;
+    out.suggested_center = f.detection.valid
+        ? f.detection.center
+        : cv::Point2f(size.width / 2.f, size.height / 2.f);
+
+    // ── Apply warp (all planes, format preserved) ────────────────────────────
+    // In deferred mode the cropper resamples just its ROI through `warp`.
+    if (deferred_warp_) {
+        out.data         = f.data;
+        out.warp_pending = true;
+        out.warp         = warp;
+        out.warp_affine  = false;
+        out.border_mode  = cv::BORDER_REPLICATE;
+    } else {
+        out.data = warp_image(f.data, f.format, warp,
+                              size, false, cv::BORDER_REPLICATE);
+    }
+
+    // ── Transform suggested center through warp ──────────────────────────────
+    if (f.detection.valid) {
+        std::vector<cv::Point2f> center_in  = { f.detection.center };
+        std::vector<cv::Point2f> center_out;
+        cv::perspectiveTransform(center_in, center_out, warp);
+
+        float cx = std::max(0.f, std::min(center_out[0].x, (float)(size.width  - 1)));
+        float cy = std::max(0.f, std::min(center_out[0].y, (float)(size.height - 1)));
+        out.suggested_center = { cx, cy };
+    }
+
     return out;
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // ed_ransac
 //
-// Pass 1: standard RANSAC homography → initial inlier set
+// Pass 1: PROSAC homography (matches ordered by Hamming distance, adaptive
+//         termination) → initial inlier set
 // Pass 2: project inliers through H, discard any with ED > ed_threshold
 // Final:  least-squares re-estimation on the clean inlier set
 // ─────────────────────────────────────────────────────────────────────────────
 
 cv::Mat EDRansacStabilizer::ed_ransac(const std::vector<cv::Point2f>& pts_prev,
-                                       const std::vector<cv::Point2f>& pts_curr) const
+                                       const std::vector<cv::Point2f>& pts_curr,
+                                       const std::vector<float>&       distances) const
 {
     if ((int)pts_prev.size() < min_inliers) return {};
 
-    // ── Pass 1: RANSAC ────────────────────────────────────────────────────────
-    cv::Mat inlier_mask;
-    cv::Mat H = cv::findHomography(pts_prev, pts_curr,
-                                   cv::RANSAC,
-                                   ransac_reproj_thresh,
-                                   inlier_mask);
-    if (H.empty()) return {};
+    // ── Pass 1: PROSAC ───────────────────────────────────────────────────────
+    estimator_.params.model     = MotionModel::Homography;
+    estimator_.params.threshold = ransac_reproj_thresh;
+
+    cv::Matx33d        H;
+    std::vector<uchar> inlier_mask;
+    if (!estimator_.estimate(pts_prev, pts_curr, distances, H, &inlier_mask)) return {};
 
     // Collect RANSAC inliers
     std::vector<cv::Point2f> inl_prev, inl_curr;
     for (int i = 0; i < (int)pts_prev.size(); ++i) {
-        if (inlier_mask.at<uchar>(i)) {
+        if (inlier_mask[i]) {
             inl_prev.push_back(pts_prev[i]);
             inl_curr.push_back(pts_curr[i]);
         }
@@ -223,28 +307,84 @@ cv::Mat EDRansacStabilizer::ed_ransac(const std::vector<cv::Point2f>& pts_prev,
     if ((int)ed_prev.size() < min_inliers) return {};
 
     // ── Final: least-squares re-estimation on clean set ──────────────────────
-    return cv::findHomography(ed_prev, ed_curr, 0);
+    cv::Matx33d H_final;
+    if (!estimator_.fit(ed_prev, ed_curr, H_final)) return {};
+    return cv::Mat(H_final);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Trajectory window
+//
+// Fixed-capacity ring of cumulative transforms with a running sum: each push
+// adds the new entry and subtracts the one falling out of the window.
+// The sum is rebuilt from the ring every kResumInterval pushes so
+// floating-point error from the add/subtract pairs cannot accumulate over a
+// multi-hour pass.
+// ─────────────────────────────────────────────────────────────────────────────
+
+namespace {
+constexpr std::size_t kResumInterval = 1024;
+}
+
+void EDRansacStabilizer::reset_trajectory()
+{
+    // Trailing mode: frames i-R..i. Lookahead mode: frames c-K..c+K, c = i-K.
+    const std::size_t cap = lookahead_ > 0
+        ? 2 * lookahead_ + 1
+        : static_cast<std::size_t>(std::max(0, smooth_radius)) + 1;
+
+    window_.assign(cap, cv::Matx33d::zeros());
+    window_head_        = 0;
+    window_count_       = 0;
+    window_sum_         = cv::Matx33d::zeros();
+    pushes_since_resum_ = 0;
+    T_last_             = cv::Matx33d::eye();
+}
+
+void EDRansacStabilizer::push_trajectory(const cv::Matx33d& T)
+{
+    if (window_.empty()) reset_trajectory();
+
+    const std::size_t cap = window_.size();
+    if (window_count_ == cap) {
+        window_sum_  -= window_[window_head_];
+        window_head_  = (window_head_ + 1) % cap;
+        --window_count_;
+    }
+
+    window_[(window_head_ + window_count_) % cap] = T;
+    ++window_count_;
+    window_sum_ += T;
+    T_last_      = T;
+
+    if (++pushes_since_resum_ >= kResumInterval) {
+        window_sum_ = cv::Matx33d::zeros();
+        for (std::size_t i = 0; i < window_count_; ++i) {
+            window_sum_ += window_[(window_head_ + i) % cap];
+        }
+        pushes_since_resum_ = 0;
+    }
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // smooth_transform
 //
-// Causal trailing-window average over the last smooth_radius trajectory entries.
+// Average over the trajectory window: the last smooth_radius entries in
+// causal mode, or the 2K+1 entries centred on the emitted frame in
+// lookahead mode.
 // Averaging 3×3 matrix entries directly is an approximation, but accurate
 // enough for the small inter-frame motions typical in satellite video.
 // ─────────────────────────────────────────────────────────────────────────────
 
-cv::Mat EDRansacStabilizer::smooth_transform(std::size_t idx) const
+// Cumulative transform `n` frames before the newest one (n < window_count_).
+const cv::Matx33d& EDRansacStabilizer::trajectory_back(std::size_t n) const
 {
-    int from  = std::max(0, (int)idx - smooth_radius);
-    int to    = (int)idx;
-
-    cv::Mat sum = cv::Mat::zeros(3, 3, CV_64F);
-    int count = 0;
-    for (int i = from; i <= to && i < (int)trajectory_.size(); ++i) {
-        sum += trajectory_[i];
-        ++count;
-    }
+    return window_[(window_head_ + window_count_ - 1 - n) % window_.size()];
+}
 
-    return count > 0 ? sum / (double)count : cv::Mat::eye(3, 3, CV_64F);
-}
\ No newline at end of file
+cv::Matx33d EDRansacStabilizer::smooth_transform() const
+{
+    return window_count_ > 0
+        ? window_sum_ * (1.0 / static_cast<double>(window_count_))
+        : cv::Matx33d::eye();
+}
@@ -1,6 +1,9 @@
 #pragma once
 
 #include "interfaces.h"
+#include "FeatureDetection/TiledOrbExtractor.h"
+#include "Geometry/RobustEstimator.h"
+#include "Matching/HammingMatcher.h"
 #include <opencv2/features2d.hpp>
 #include <deque>
 
@@ -14,6 +17,7 @@ public:
     float  ed_threshold          = 0.5f;  // pixels
     int    min_inliers           = 10;
     int    smooth_radius         = 15;    // trailing frames
+    int    lookahead             = 0;     // K > 0: centred ±K window, output delayed by K frames
 
     EDRansacStabilizer()  = default;
     ~EDRansacStabilizer() override = default;
@@ -26,20 +30,50 @@ public:
     StabilizedFrame stabilize(const RawFrame&        frame,
                               const DetectionResult& detection) override;
 
-    void flush() override {}
+    // Emits the frames still held back by the lookahead via drain().
+    void flush() override;
+    bool drain(StabilizedFrame& out) override;
+
+    void set_deferred_warp(bool enable) override { deferred_warp_ = enable; }
 
 private:
     //Could also use SIFT, BRISK or Fast, for fast we would also need a descriptor, but we do that in the detector, so that approach can be reused
     cv::Ptr<cv::ORB>     sharedorb_;
     cv::Ptr<cv::ORB>     ownedorb_;
-    cv::Ptr<cv::BFMatcher> matcher_;
+    HammingMatcher       matcher_;
+
+    // Parallel ORB over the frame (get_features() is const, hence mutable)
+    mutable TiledOrbExtractor extractor_;
+
+    // PROSAC homography for ed_ransac() (scratch buffers, hence mutable)
+    mutable RobustEstimator estimator_;
 
     // Previous-frame data (for adjacent-frame registration)
     cv::Mat prev_gray_;
     std::vector<cv::KeyPoint> prev_kps_;
     cv::Mat                   prev_desc_;
 
-    std::vector<cv::Mat> trajectory_;
+    // Trajectory window: ring of the last smooth_radius + 1 cumulative
+    // transforms (frame 0 → frame i) plus their running sum, so smoothing
+    // is O(1) per frame and memory does not grow with stream length.
+    std::vector<cv::Matx33d> window_;
+    std::size_t              window_head_  = 0;    // oldest entry
+    std::size_t              window_count_ = 0;
+    cv::Matx33d              window_sum_   = cv::Matx33d::zeros();
+    std::size_t              pushes_since_resum_ = 0;
+    cv::Matx33d              T_last_       = cv::Matx33d::eye();
+
+    // Lookahead buffer: frames waiting for K successors (held by reference,
+    // not copied) and frames produced by flush() awaiting drain().
+    struct PendingFrame {
+        cv::Mat         data;
+        PixelFormat     format;
+        std::int64_t    pts_ns;
+        DetectionResult detection;
+    };
+    std::size_t                 lookahead_ = 0;
+    std::deque<PendingFrame>    pending_;
+    std::deque<StabilizedFrame> drained_;
 
     
     //Helpers
@@ -48,16 +82,25 @@ private:
         return sharedorb_ ? sharedorb_ : ownedorb_;
     }
 
-    void get_features(RawFrame&                  frame,
+    void get_features(const RawFrame&            frame,
                       const cv::Mat&             gray,
                       std::vector<cv::KeyPoint>& kps,
                       cv::Mat&                   desc) const;
 
     cv::Mat ed_ransac(const std::vector<cv::Point2f>& pts_prev,
-                      const std::vector<cv::Point2f>& pts_curr) const;
+                      const std::vector<cv::Point2f>& pts_curr,
+                      const std::vector<float>&       distances) const;
+
+    void               reset_trajectory();
+    void               push_trajectory(const cv::Matx33d& T);
+    const cv::Matx33d& trajectory_back(std::size_t n) const;
+    cv::Matx33d        smooth_transform() const;
 
-    cv::Mat smooth_transform(std::size_t idx) const;
+    StabilizedFrame make_output(const PendingFrame& f,
+                                const cv::Matx33d&  T_smooth,
+                                const cv::Matx33d&  T_frame) const;
 
     bool initialized_ = false;
+    bool deferred_warp_ = false;
     std::size_t frame_idx_ = 0;
 };
\ No newline at end of file
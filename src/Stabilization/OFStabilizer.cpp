@@ -1,4 +1,6 @@
 #include "Stabilization/OFStabilizer.h"
+#include "Common/FrameCache.h"
+#include "Common/ImageOps.h"
 #include <opencv2/calib3d.hpp>
 #include <opencv2/features2d.hpp>
 #include <iostream>
@@ -19,7 +21,7 @@ bool OFStabilizer::init(const std::string &, const std::string &)
     matcher_ = cv::BFMatcher::create(cv::NORM_HAMMING, false);
 
     frame_idx_ = 0;
-    prev_gray_.release();
+    prev_pyr_.clear();
     prev_kps_.clear();
     prev_desc_.release();
 
@@ -27,60 +29,62 @@ bool OFStabilizer::init(const std::string &, const std::string &)
     return true;
 }
 
-void OFStabilizer::get_features(RawFrame &frame,
+void OFStabilizer::get_features(const RawFrame &frame,
                                 const cv::Mat &gray,
                                 std::vector<cv::KeyPoint> &kps,
                                 cv::Mat &desc) const
 {
-    if (frame.features_computed)
+    FrameCache &cache = frame.cache;
+    if (cache.features_computed)
     {
         // ORBDetector already ran on this frame — reuse its results
-        kps = frame.keypoints;
-        desc = frame.descriptors;
+        kps = cache.keypoints;
+        desc = cache.descriptors;
         return;
     }
 
     // Compute features ourselves using whichever ORB model is active
-    active_orb()->detectAndCompute(gray, cv::noArray(), kps, desc);
+    extractor_.detect_and_compute(active_orb(), gray, kps, desc);
 
     // Cache so that any later pipeline stage can also reuse them
-    frame.keypoints = kps;
-    frame.descriptors = desc;
-    frame.features_computed = true;
+    cache.keypoints = kps;
+    cache.descriptors = desc;
+    cache.features_computed = true;
 }
 
 StabilizedFrame OFStabilizer::stabilize(const RawFrame &frame,
                                         const DetectionResult &detection)
 {
-    // Cast away const to cache features on this frame
-    RawFrame &mutable_frame = const_cast<RawFrame &>(frame);
+    const cv::Size size = image_size(frame.data, frame.format);
 
     StabilizedFrame out;
     out.pts_ns = frame.pts_ns;
+    out.format = frame.format;
 
-    const cv::Point2f fallback_center(frame.data.cols / 2.f, frame.data.rows / 2.f);
+    const cv::Point2f fallback_center(size.width / 2.f, size.height / 2.f);
     out.suggested_center = detection.valid ? detection.center : fallback_center;
 
     cv::Mat frameMat = frame.data;
-    cv::Mat gray;
-    cv::cvtColor(frameMat, gray, cv::COLOR_BGR2GRAY);
+    const cv::Mat &gray = cached_gray(frame);
 
-    if (prevGray.empty() || prev_pts_.empty())
+    // Built once here; becomes next frame's prev_pyr_ without copying
+    const cv::Size lk_win(lk_win_size, lk_win_size);
+    const std::vector<cv::Mat> &curr_pyr = cached_lk_pyramid(frame, lk_win, lk_max_level);
+
+    if (prev_pyr_.empty() || prev_pts_.empty())
     {
         std::vector<cv::KeyPoint> curr_kps;
         cv::Mat curr_desc;
-        get_features(mutable_frame, gray, curr_kps, curr_desc);
+        get_features(frame, gray, curr_kps, curr_desc);
 
         prev_pts_.clear();
         prev_pts_.reserve(curr_kps.size());
         for (const auto &kp : curr_kps) prev_pts_.push_back(kp.pt);
 
-        prev_gray_ = gray.clone();
+        prev_pyr_ = curr_pyr;
         prev_kps_ = curr_kps;
         prev_desc_ = curr_desc;
-        prevGray = gray.clone();
 
-        StabilizedFrame result;
         out.data = frameMat;
         ++frame_idx_;
         return out;
@@ -91,15 +95,18 @@ StabilizedFrame OFStabilizer::stabilize(const RawFrame &frame,
     std::vector<float> err;
 
     cv::calcOpticalFlowPyrLK(
-        prev_gray_,
-        gray,
+        prev_pyr_,
+        curr_pyr,
         prev_pts_,
         curr_pts,
         status,
-        err);
+        err,
+        lk_win,
+        lk_max_level);
 
     std::vector<cv::Point2f> prevFiltered;
     std::vector<cv::Point2f> currFiltered;
+    std::vector<float> errFiltered;
 
     for (size_t i = 0; i < status.size(); i++)
     {
@@ -107,6 +114,7 @@ StabilizedFrame OFStabilizer::stabilize(const RawFrame &frame,
         {
             prevFiltered.push_back(prev_pts_[i]);
             currFiltered.push_back(curr_pts[i]);
+            errFiltered.push_back(err[i]);
         }
     }
 
@@ -115,29 +123,31 @@ StabilizedFrame OFStabilizer::stabilize(const RawFrame &frame,
         std::vector<cv::KeyPoint> kps;
         cv::Mat desc;
 
-        get_features(mutable_frame, gray, kps, desc);
+        get_features(frame, gray, kps, desc);
 
         prev_pts_.clear();
         for (const auto &kp : kps)
             prev_pts_.push_back(kp.pt);
 
-        prev_gray_ = gray.clone();
+        prev_pyr_ = curr_pyr;
 
-        StabilizedFrame result;
-        result.data = frameMat;
+        out.data = frameMat;
 
         ++frame_idx_;
-        return result;
+        return out;
     }
 
-    cv::Mat T = cv::estimateAffinePartial2D(prevFiltered, currFiltered); // denne extractor et 2 x 3 matrix.
+    // 2 x 3 rotation + scale + translation (the estimator returns it as 3 x 3)
+    cv::Matx33d A;
+    cv::Mat T;
+    if (estimator_.estimate(prevFiltered, currFiltered, errFiltered, A))
+        T = cv::Mat(A).rowRange(0, 2).clone();
 
     if (T.empty())
     {
         prev_pts_ = currFiltered;
-        prev_gray_ = gray.clone();
+        prev_pyr_ = curr_pyr;
 
-        StabilizedFrame result;
         out.data = frameMat;
 
         ++frame_idx_;
@@ -171,24 +181,36 @@ StabilizedFrame OFStabilizer::stabilize(const RawFrame &frame,
     smoothedT.at<double>(0, 2) = diff_dx;
     smoothedT.at<double>(1, 2) = diff_dy;
 
-    cv::Mat stabilized;
-    cv::warpAffine(frameMat, stabilized, smoothedT, frameMat.size(),
-               cv::INTER_LINEAR, cv::BORDER_REFLECT);
-
     cv::Mat warp3x3 = cv::Mat::eye(3, 3, CV_64F);
     smoothedT.copyTo(warp3x3.rowRange(0, 2));
 
+    cv::Mat stabilized;
+    if (deferred_warp_)
+    {
+        // The cropper resamples only its ROI through this warp
+        stabilized = frameMat;
+        out.warp_pending = true;
+        out.warp = warp3x3;
+        out.warp_affine = true;
+        out.border_mode = cv::BORDER_REFLECT;
+    }
+    else
+    {
+        stabilized = warp_image(frameMat, frame.format, warp3x3, size,
+                                true, cv::BORDER_REFLECT);
+    }
+
     std::vector<cv::Point2f> center_in  = { detection.valid ? detection.center : fallback_center };
     std::vector<cv::Point2f> center_out;
     cv::perspectiveTransform(center_in, center_out, warp3x3);
 
     out.suggested_center = {
-        std::max(0.f, std::min(center_out[0].x, static_cast<float>(stabilized.cols - 1))),
-        std::max(0.f, std::min(center_out[0].y, static_cast<float>(stabilized.rows - 1)))
+        std::max(0.f, std::min(center_out[0].x, static_cast<float>(size.width - 1))),
+        std::max(0.f, std::min(center_out[0].y, static_cast<float>(size.height - 1)))
     };
     
     prev_pts_ = currFiltered;
-    prev_gray_ = gray.clone();
+    prev_pyr_ = curr_pyr;
 
     if (frame_idx_ % 30 == 0)
     {
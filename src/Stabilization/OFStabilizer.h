@@ -1,6 +1,8 @@
 #pragma once
 
 #include "interfaces.h"
+#include "FeatureDetection/TiledOrbExtractor.h"
+#include "Geometry/RobustEstimator.h"
 #include <opencv2/features2d.hpp>
 #include <deque>
 
@@ -18,18 +20,30 @@ public:
     // Allow setting a shared ORB model (e.g., from ORBDetector)
     void set_orb_model(cv::Ptr<cv::ORB> orb) { sharedorb_ = orb; }
 
+    // Leave the warp to the cropper (see IVideoStabilizer)
+    void set_deferred_warp(bool enable) override { deferred_warp_ = enable; }
+
 private:
     static constexpr int orb_n_features = 300;  // Reduced from 1000 for faster matching
+    static constexpr int lk_win_size    = 21;   // calcOpticalFlowPyrLK defaults
+    static constexpr int lk_max_level   = 3;
     
     cv::Ptr<cv::ORB>        sharedorb_;      // May be set by ORBDetector
     cv::Ptr<cv::ORB>        ownedorb_;       // Create our own if no shared model
     cv::Ptr<cv::BFMatcher>  matcher_;
 
-    cv::Mat prevGray;
+    // Parallel ORB over the frame (get_features() is const, hence mutable)
+    mutable TiledOrbExtractor extractor_;
+
+    // Rotation + scale + translation between frames; PROSAC ordered by LK error
+    RobustEstimator estimator_{ RobustParams{ MotionModel::AffinePartial } };
+
     cv::Mat smoothedTransform = cv::Mat::eye(2, 3, CV_64F);
     double alpha = 0.9; // If we need better stabilization then lower this number. (when lowering the number this latentcy is getting worse)
 
-    cv::Mat prev_gray_;
+    // Previous frame's LK pyramid (built once per frame, shared with the
+    // frame cache — no pixel copies).
+    std::vector<cv::Mat> prev_pyr_;
     std::vector<cv::KeyPoint> prev_kps_;
     cv::Mat prev_desc_;
     std::vector<cv::Point2f> prev_pts_;
@@ -47,13 +61,14 @@ private:
     double diff_da;
     
     size_t frame_idx_ = 0;
+    bool deferred_warp_ = false;
 
     // Get the active ORB detector (shared or owned)
     cv::Ptr<cv::ORB> active_orb() const {
         return sharedorb_ ? sharedorb_ : ownedorb_;
     }
 
-    void get_features(RawFrame&                  frame,
+    void get_features(const RawFrame&            frame,
                       const cv::Mat&             gray,
                       std::vector<cv::KeyPoint>& kps,
                       cv::Mat&                   desc) const;
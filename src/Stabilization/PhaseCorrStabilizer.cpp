@@ -0,0 +1,278 @@
+#include "Stabilization/PhaseCorrStabilizer.h"
+#include "Common/ConfigString.h"
+#include "Common/FrameCache.h"
+#include "Common/ImageOps.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+cv::Matx33d translation(double x, double y)
+{
+    return cv::Matx33d(1, 0, x,
+                       0, 1, y,
+                       0, 0, 1);
+}
+
+// Rotation by `angle` (radians, image coordinates) and uniform `scale`.
+cv::Matx33d similarity(double angle, double scale)
+{
+    const double c = scale * std::cos(angle);
+    const double s = scale * std::sin(angle);
+    return cv::Matx33d(c, -s, 0,
+                       s,  c, 0,
+                       0,  0, 1);
+}
+
+} // namespace
+
+bool PhaseCorrStabilizer::init(const std::string& model_config, const std::string&)
+{
+    const ConfigString options(model_config);
+    analysis_width = options.get_int("analysis_width", analysis_width);
+    rotation_scale = options.get_bool("rotation_scale", rotation_scale);
+    alpha          = options.get_float("alpha", static_cast<float>(alpha));
+    min_response   = options.get_float("min_response", static_cast<float>(min_response));
+    options.warn_unused("[PhaseCorrStabilizer]");
+
+    if (analysis_width < 32) {
+        std::cerr << "[PhaseCorrStabilizer] analysis_width must be at least 32.\n";
+        return false;
+    }
+
+    frame_size_ = cv::Size();
+    has_prev_   = false;
+    traj_       = cv::Vec4d::all(0.0);
+    smoothed_   = cv::Vec4d::all(0.0);
+    frame_idx_  = 0;
+
+    std::cout << "[PhaseCorrStabilizer] Initialized (analysis width " << analysis_width
+              << (rotation_scale ? ", rotation + scale" : ", translation only")
+              << ", alpha=" << alpha << ").\n";
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Setup
+// ─────────────────────────────────────────────────────────────────────────────
+
+void PhaseCorrStabilizer::configure(cv::Size frame_size)
+{
+    frame_size_ = frame_size;
+    has_prev_   = false;
+
+    const int width  = cv::getOptimalDFTSize(std::min(analysis_width, frame_size.width));
+    const int height = cv::getOptimalDFTSize(std::max(
+        1, static_cast<int>(std::lround(static_cast<double>(frame_size.height) * width /
+                                        frame_size.width))));
+    analysis_size_ = cv::Size(width, height);
+
+    // Deepest pyramid level still at least the analysis size
+    level_ = 0;
+    while ((frame_size.width  >> (level_ + 1)) >= width &&
+           (frame_size.height >> (level_ + 1)) >= height) {
+        ++level_;
+    }
+
+    translator_.configure(analysis_size_);
+
+    // Rotation/scale: an even-sided central square, its spectrum in log-polar
+    const int side = std::min(width, height) & ~1;
+    square_        = cv::Rect((width - side) / 2, (height - side) / 2, side, side);
+    polar_size_    = cv::Size(side, side);
+    polar_radius_  = side / 2.0;
+    square_pc_.configure(square_.size());
+    polar_pc_.configure(polar_size_);
+
+    // (1 - X)(2 - X) with X = cos(πξ)cos(πη): suppresses the low
+    // frequencies that carry little rotation information
+    highpass_.create(side, side, CV_32F);
+    for (int y = 0; y < side; ++y) {
+        float*       row = highpass_.ptr<float>(y);
+        const double eta = static_cast<double>(y - side / 2) / side;
+        for (int x = 0; x < side; ++x) {
+            const double xi = static_cast<double>(x - side / 2) / side;
+            const double X  = std::cos(CV_PI * xi) * std::cos(CV_PI * eta);
+            row[x] = static_cast<float>((1.0 - X) * (2.0 - X));
+        }
+    }
+    magnitude_.create(side, side, CV_32F);
+
+    std::cout << "[PhaseCorrStabilizer] " << frame_size.width << "x" << frame_size.height
+              << " → " << width << "x" << height << " analysis (pyramid level " << level_
+              << ")\n";
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Analysis
+// ─────────────────────────────────────────────────────────────────────────────
+
+void PhaseCorrStabilizer::analyse(const RawFrame& frame)
+{
+    const cv::Mat& source = level_ > 0 ? cached_pyramid(frame, level_ + 1)[level_]
+                                       : cached_gray(frame);
+    cv::resize(source, resized_, analysis_size_, 0, 0, cv::INTER_AREA);
+    resized_.convertTo(small_, CV_32F, 1.0 / 255.0);
+}
+
+void PhaseCorrStabilizer::log_polar()
+{
+    square_pc_.transform(small_(square_), square_spec_);
+
+    // Centred (fft-shifted), high-pass filtered log magnitude
+    const int side = square_.width;
+    const int half = side / 2;
+    for (int y = 0; y < side; ++y) {
+        const float* spec = square_spec_.ptr<float>(y);
+        float*       dst  = magnitude_.ptr<float>((y + half) % side);
+        const float* hp   = highpass_.ptr<float>((y + half) % side);
+        for (int x = 0; x < side; ++x) {
+            const int   xs  = (x + half) % side;
+            const float mag = std::sqrt(spec[2 * x] * spec[2 * x] + spec[2 * x + 1] * spec[2 * x + 1]);
+            dst[xs] = std::log1p(mag) * hp[xs];
+        }
+    }
+
+    cv::warpPolar(magnitude_, lp_, polar_size_, cv::Point2f(half, half), polar_radius_,
+                  cv::INTER_LINEAR | cv::WARP_POLAR_LOG);
+}
+
+cv::Matx33d PhaseCorrStabilizer::estimate_motion()
+{
+    // ── Rotation and scale ───────────────────────────────────────────────────
+    double angle = 0.0;    // radians
+    double scale = 1.0;
+    if (rotation_scale) {
+        log_polar();
+        polar_pc_.transform(lp_, curr_lp_spec_);
+
+        if (has_prev_ && !prev_lp_spec_.empty()) {
+            double response = 0.0;
+            const cv::Point2d d = polar_pc_.correlate(curr_lp_spec_, prev_lp_spec_, response);
+            if (response >= min_response) {
+                // Rows span 360°, but the spectrum repeats every 180°
+                const double period = polar_size_.height / 2.0;
+                double rows = std::fmod(d.y, period);
+                if (rows >  period / 2) rows -= period;
+                if (rows < -period / 2) rows += period;
+
+                angle = rows * 2.0 * CV_PI / polar_size_.height;
+                scale = std::exp(-d.x * std::log(polar_radius_) / polar_size_.width);
+            }
+        }
+        std::swap(curr_lp_spec_, prev_lp_spec_);
+    }
+
+    translator_.transform(small_, curr_spec_);
+    if (!has_prev_) {
+        std::swap(curr_spec_, prev_spec_);
+        return cv::Matx33d::eye();
+    }
+
+    // ── Translation (after undoing rotation/scale about the centre) ─────────
+    const cv::Point2d c(analysis_size_.width / 2.0, analysis_size_.height / 2.0);
+    double       response = 0.0;
+    cv::Point2d  d;
+    if (angle != 0.0 || scale != 1.0) {
+        const cv::Mat undo = cv::getRotationMatrix2D(cv::Point2f(c), angle * 180.0 / CV_PI, 1.0 / scale);
+        cv::warpAffine(small_, derotated_, undo, analysis_size_, cv::INTER_LINEAR,
+                       cv::BORDER_REFLECT);
+        translator_.transform(derotated_, derotated_spec_);
+        d = translator_.correlate(derotated_spec_, prev_spec_, response);
+    } else {
+        d = translator_.correlate(curr_spec_, prev_spec_, response);
+    }
+    std::swap(curr_spec_, prev_spec_);
+
+    last_response_ = response;
+    if (response < min_response) {
+        ++low_response_;
+        return cv::Matx33d::eye();
+    }
+
+    // curr = c + s·R·(prev + d - c), then analysis → frame pixels
+    const cv::Matx33d M = translation(c.x, c.y) * similarity(angle, scale) *
+                          translation(d.x - c.x, d.y - c.y);
+    const double kx = static_cast<double>(analysis_size_.width)  / frame_size_.width;
+    const double ky = static_cast<double>(analysis_size_.height) / frame_size_.height;
+    const cv::Matx33d K(kx, 0, 0, 0, ky, 0, 0, 0, 1);
+    return K.inv() * M * K;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// stabilize
+// ─────────────────────────────────────────────────────────────────────────────
+
+StabilizedFrame PhaseCorrStabilizer::stabilize(const RawFrame&        frame,
+                                               const DetectionResult& detection)
+{
+    const cv::Size size = image_size(frame.data, frame.format);
+
+    StabilizedFrame out;
+    out.pts_ns = frame.pts_ns;
+    out.format = frame.format;
+
+    const cv::Point2f fallback_center(size.width / 2.f, size.height / 2.f);
+    out.suggested_center = detection.valid ? detection.center : fallback_center;
+
+    if (size != frame_size_) configure(size);
+
+    analyse(frame);
+    const cv::Matx33d motion = estimate_motion();
+    const bool        first  = !has_prev_;
+    has_prev_ = true;
+
+    if (first) {
+        out.data = frame.data;
+        ++frame_idx_;
+        return out;
+    }
+
+    // ── Accumulate and smooth the trajectory ─────────────────────────────────
+    const cv::Vec3d   centre(size.width / 2.0, size.height / 2.0, 1.0);
+    const cv::Vec3d   moved = motion * centre;
+    traj_ += cv::Vec4d(moved[0] - centre[0],
+                       moved[1] - centre[1],
+                       std::atan2(motion(1, 0), motion(0, 0)),
+                       std::log(std::hypot(motion(0, 0), motion(1, 0))));
+    smoothed_ = alpha * smoothed_ + (1.0 - alpha) * traj_;
+    const cv::Vec4d diff = smoothed_ - traj_;
+
+    // Correction about the frame centre
+    const cv::Matx33d warp = translation(centre[0] + diff[0], centre[1] + diff[1]) *
+                             similarity(diff[2], std::exp(diff[3])) *
+                             translation(-centre[0], -centre[1]);
+
+    if (deferred_warp_) {
+        // The cropper resamples only its ROI through this warp
+        out.data         = frame.data;
+        out.warp_pending = true;
+        out.warp         = warp;
+        out.warp_affine  = true;
+        out.border_mode  = cv::BORDER_REFLECT;
+    } else {
+        out.data = warp_image(frame.data, frame.format, warp, size, true, cv::BORDER_REFLECT);
+    }
+
+    std::vector<cv::Point2f> center_in  = { out.suggested_center };
+    std::vector<cv::Point2f> center_out;
+    cv::perspectiveTransform(center_in, center_out, warp);
+    out.suggested_center = {
+        std::max(0.f, std::min(center_out[0].x, static_cast<float>(size.width - 1))),
+        std::max(0.f, std::min(center_out[0].y, static_cast<float>(size.height - 1)))
+    };
+
+    if (frame_idx_ % 30 == 0) {
+        std::cout << "[PhaseCorrStabilizer] Frame " << frame_idx_
+                  << " | shift (" << moved[0] - centre[0] << ", " << moved[1] - centre[1]
+                  << ") px | response " << last_response_
+                  << " | low-response frames: " << low_response_ << "\n";
+    }
+
+    ++frame_idx_;
+    return out;
+}
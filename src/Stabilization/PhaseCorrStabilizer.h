@@ -0,0 +1,104 @@
+#pragma once
+
+#include "interfaces.h"
+#include "Geometry/PhaseCorrelator.h"
+
+#include <cstddef>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// PhaseCorrStabilizer
+//
+// Global-motion stabilizer without keypoints: frame-to-frame motion comes
+// from FFT phase correlation of a downsampled luma image, so it keeps
+// working on low-texture sea and cloud scenes where ORB/LK find too little,
+// and its cost does not depend on the scene.
+//
+//   init("analysis_width=512,rotation_scale=1")
+//
+// Design:
+//   - Luma from the shared frame pyramid, resized to analysis_width
+//     (rounded to a DFT-friendly size) and Hann-windowed
+//   - Translation: phase correlation against the previous frame's
+//     spectrum, which is kept, so each frame is transformed once
+//   - Optional rotation + scale (rotation_scale): log-polar resampling of
+//     the high-pass filtered magnitude spectrum of the central square,
+//     phase-correlated against the previous frame's (Reddy & Chatterji).
+//     The frame is de-rotated before the translation step. Rotations are
+//     folded into ±90°, the magnitude spectrum being symmetric
+//   - A correlation peak below min_response means no reliable motion:
+//     that frame counts as static instead of injecting a bad estimate
+//   - Trajectory smoothing as in OFStabilizer (exponential, alpha), but
+//     rotation/scale are applied about the frame centre
+//   - All images, spectra and windows are sized once per input resolution
+//     and reused
+// ─────────────────────────────────────────────────────────────────────────────
+
+class PhaseCorrStabilizer : public IVideoStabilizer {
+public:
+    int    analysis_width = 512;     // px, before DFT-size rounding
+    bool   rotation_scale = false;   // also estimate rotation and zoom
+    double alpha          = 0.9;     // trajectory smoothing, as OFStabilizer
+    double min_response   = 0.05;    // correlation peak height, 0..1
+
+    PhaseCorrStabilizer()  = default;
+    ~PhaseCorrStabilizer() override = default;
+
+    // model_config may override the fields above, e.g.
+    // "analysis_width=384,rotation_scale=1,alpha=0.95". No weights.
+    bool init(const std::string& model_config  = "",
+              const std::string& model_weights = "") override;
+
+    StabilizedFrame stabilize(const RawFrame&        frame,
+                              const DetectionResult& detection) override;
+
+    void flush() override {}
+
+    void set_deferred_warp(bool enable) override { deferred_warp_ = enable; }
+
+private:
+    // Buffers and scales for a new input resolution; forgets the previous frame.
+    void configure(cv::Size frame_size);
+
+    // small_ ← analysis image of `frame`
+    void analyse(const RawFrame& frame);
+
+    // log-polar magnitude spectrum of the central square of small_ → lp_
+    void log_polar();
+
+    // prev → curr motion in frame pixels (identity when unreliable)
+    cv::Matx33d estimate_motion();
+
+    // ── Analysis geometry ────────────────────────────────────────────────────
+    cv::Size    frame_size_;
+    cv::Size    analysis_size_;
+    int         level_ = 0;          // frame pyramid level resized from
+    cv::Rect    square_;             // central square of the analysis image
+    cv::Size    polar_size_;         // cols: log radius, rows: angle
+    double      polar_radius_ = 1.0;
+
+    PhaseCorrelator translator_;     // analysis_size_
+    PhaseCorrelator square_pc_;      // square_.size()
+    PhaseCorrelator polar_pc_;       // polar_size_
+
+    // ── Reused buffers ───────────────────────────────────────────────────────
+    cv::Mat resized_;                // CV_8U analysis image
+    cv::Mat small_;                  // CV_32F analysis image
+    cv::Mat derotated_;
+    cv::Mat highpass_;               // Reddy–Chatterji filter, centred
+    cv::Mat magnitude_;              // centred log magnitude spectrum
+    cv::Mat lp_;
+    cv::Mat square_spec_;
+    cv::Mat curr_spec_, prev_spec_;
+    cv::Mat curr_lp_spec_, prev_lp_spec_;
+    cv::Mat derotated_spec_;
+    bool    has_prev_ = false;
+
+    // ── Trajectory (translation of the centre, angle, log scale) ────────────
+    cv::Vec4d traj_     = cv::Vec4d::all(0.0);
+    cv::Vec4d smoothed_ = cv::Vec4d::all(0.0);
+
+    double      last_response_ = 0.0;
+    std::size_t low_response_  = 0;
+    std::size_t frame_idx_     = 0;
+    bool        deferred_warp_ = false;
+};
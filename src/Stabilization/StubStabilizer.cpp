@@ -1,4 +1,5 @@
 #include "Stabilization/StubStabilizer.h"
+#include "Common/ImageOps.h"
 #include <iostream>
 
 bool StubStabilizer::init(const std::string&, const std::string&)
@@ -14,11 +15,13 @@ StabilizedFrame StubStabilizer::stabilize(const RawFrame&       frame,
     // No-op: forward the frame and centre unchanged.
     StabilizedFrame sf;
     sf.data             = frame.data;        // zero-copy (same Mat header)
+    sf.format           = frame.format;
     if(detection.valid){
         sf.suggested_center = detection.center;
     } else {
-        sf.suggested_center = { static_cast<float>(frame.data.cols) / 2.f,
-                     static_cast<float>(frame.data.rows) / 2.f };
+        const cv::Size size = image_size(frame.data, frame.format);
+        sf.suggested_center = { static_cast<float>(size.width) / 2.f,
+                     static_cast<float>(size.height) / 2.f };
     }
     sf.pts_ns           = frame.pts_ns;
     return sf;
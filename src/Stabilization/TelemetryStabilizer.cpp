@@ -0,0 +1,244 @@
+#include "Stabilization/TelemetryStabilizer.h"
+#include "Common/ConfigString.h"
+#include "Common/FrameCache.h"
+#include "Common/ImageOps.h"
+
+#include <opencv2/imgproc.hpp>
+
+#include <algorithm>
+#include <cmath>
+#include <iostream>
+
+namespace {
+
+cv::Matx33d translation(double x, double y)
+{
+    return cv::Matx33d(1, 0, x,
+                       0, 1, y,
+                       0, 0, 1);
+}
+
+// Rotation angle of a unit quaternion, degrees.
+double angle_deg(const Quaternion& q)
+{
+    return 2.0 * std::acos(std::min(1.0, std::abs(q.w))) * 180.0 / CV_PI;
+}
+
+} // namespace
+
+bool TelemetryStabilizer::init(const std::string& model_config, const std::string& model_weights)
+{
+    const ConfigString options(model_config);
+    hfov_deg       = options.get_float("hfov_deg", static_cast<float>(hfov_deg));
+    fx             = options.get_float("fx", static_cast<float>(fx));
+    fy             = options.get_float("fy", static_cast<float>(fy));
+    cx             = options.get_float("cx", static_cast<float>(cx));
+    cy             = options.get_float("cy", static_cast<float>(cy));
+    time_offset_ms = options.get_float("time_offset_ms", static_cast<float>(time_offset_ms));
+    mount.w        = options.get_float("mount_qw", static_cast<float>(mount.w));
+    mount.x        = options.get_float("mount_qx", static_cast<float>(mount.x));
+    mount.y        = options.get_float("mount_qy", static_cast<float>(mount.y));
+    mount.z        = options.get_float("mount_qz", static_cast<float>(mount.z));
+    alpha          = options.get_float("alpha", static_cast<float>(alpha));
+    refine         = options.get_bool("refine", refine);
+    refine_width   = options.get_int("refine_width", refine_width);
+    min_response   = options.get_float("min_response", static_cast<float>(min_response));
+    track_.max_gap_ns = static_cast<std::int64_t>(
+        options.get_float("max_gap_ms", static_cast<float>(track_.max_gap_ns / 1e6)) * 1e6);
+    options.warn_unused("[TelemetryStabilizer]");
+
+    if (model_weights.empty()) {
+        std::cerr << "[TelemetryStabilizer] No attitude sidecar given.\n";
+        return false;
+    }
+    if (!track_.load(model_weights)) return false;
+
+    if (fx <= 0.0 && (hfov_deg <= 0.0 || hfov_deg >= 180.0)) {
+        std::cerr << "[TelemetryStabilizer] hfov_deg must be in (0, 180) when fx is not set.\n";
+        return false;
+    }
+    if (refine && refine_width < 32) {
+        std::cerr << "[TelemetryStabilizer] refine_width must be at least 32.\n";
+        return false;
+    }
+    mount = mount.normalized();
+
+    frame_size_ = cv::Size();
+    has_prev_   = false;
+    frame_idx_  = 0;
+    uncovered_  = 0;
+
+    std::cout << "[TelemetryStabilizer] Initialized (alpha=" << alpha
+              << ", time offset " << time_offset_ms << " ms"
+              << (refine ? ", visual refinement" : "") << ").\n";
+    return true;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Setup
+// ─────────────────────────────────────────────────────────────────────────────
+
+void TelemetryStabilizer::configure(cv::Size frame_size)
+{
+    frame_size_ = frame_size;
+    has_prev_   = false;
+
+    const double focal_x = fx > 0.0 ? fx
+                                    : 0.5 * frame_size.width /
+                                          std::tan(0.5 * hfov_deg * CV_PI / 180.0);
+    const double focal_y = fy > 0.0 ? fy : focal_x;
+    const double centre_x = cx >= 0.0 ? cx : 0.5 * (frame_size.width - 1);
+    const double centre_y = cy >= 0.0 ? cy : 0.5 * (frame_size.height - 1);
+    K_ = cv::Matx33d(focal_x, 0,       centre_x,
+                     0,       focal_y, centre_y,
+                     0,       0,       1);
+    K_inv_ = K_.inv();
+
+    if (refine) {
+        const int width  = cv::getOptimalDFTSize(std::min(refine_width, frame_size.width));
+        const int height = cv::getOptimalDFTSize(std::max(
+            1, static_cast<int>(std::lround(static_cast<double>(frame_size.height) * width /
+                                            frame_size.width))));
+        analysis_size_  = cv::Size(width, height);
+        analysis_scale_ = static_cast<double>(width) / frame_size.width;
+
+        level_ = 0;
+        while ((frame_size.width  >> (level_ + 1)) >= width &&
+               (frame_size.height >> (level_ + 1)) >= height) {
+            ++level_;
+        }
+        correlator_.configure(analysis_size_);
+        prev_spec_.release();
+    }
+
+    std::cout << "[TelemetryStabilizer] " << frame_size.width << "x" << frame_size.height
+              << ", f = (" << focal_x << ", " << focal_y << ") px\n";
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Visual refinement
+// ─────────────────────────────────────────────────────────────────────────────
+
+cv::Point2d TelemetryStabilizer::residual_shift(const RawFrame&    frame,
+                                                const cv::Matx33d& prev_from_curr)
+{
+    const cv::Mat& source = level_ > 0 ? cached_pyramid(frame, level_ + 1)[level_]
+                                       : cached_gray(frame);
+    cv::resize(source, resized_, analysis_size_, 0, 0, cv::INTER_AREA);
+    resized_.convertTo(small_, CV_32F, 1.0 / 255.0);
+
+    cv::Point2d shift;
+    if (!prev_spec_.empty()) {
+        // The previous frame as predicted from the attitude change
+        const cv::Matx33d S(analysis_scale_, 0, 0, 0, analysis_scale_, 0, 0, 0, 1);
+        cv::warpPerspective(small_, predicted_, S * prev_from_curr * S.inv(), analysis_size_,
+                            cv::INTER_LINEAR, cv::BORDER_REFLECT);
+        correlator_.transform(predicted_, curr_spec_);
+
+        double response = 0.0;
+        const cv::Point2d d = correlator_.correlate(curr_spec_, prev_spec_, response);
+        last_response_ = response;
+        if (response >= min_response) {
+            shift = d * (1.0 / analysis_scale_);
+        } else {
+            ++low_response_;
+        }
+    }
+
+    // The next frame is predicted into this one's unwarped coordinates
+    correlator_.transform(small_, prev_spec_);
+    return shift;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// stabilize
+// ─────────────────────────────────────────────────────────────────────────────
+
+StabilizedFrame TelemetryStabilizer::stabilize(const RawFrame&        frame,
+                                               const DetectionResult& detection)
+{
+    const cv::Size size = image_size(frame.data, frame.format);
+
+    StabilizedFrame out;
+    out.pts_ns = frame.pts_ns;
+    out.format = frame.format;
+    out.data   = frame.data;
+
+    const cv::Point2f fallback_center(size.width / 2.f, size.height / 2.f);
+    out.suggested_center = detection.valid ? detection.center : fallback_center;
+
+    if (size != frame_size_) configure(size);
+
+    // ── Attitude at this frame ───────────────────────────────────────────────
+    const std::int64_t t_ns =
+        frame.pts_ns + static_cast<std::int64_t>(std::llround(time_offset_ms * 1e6));
+    Quaternion body;
+    if (!track_.at(t_ns, body)) {
+        if (uncovered_++ == 0 || frame_idx_ % 30 == 0) {
+            std::cerr << "[TelemetryStabilizer] No attitude at t = " << t_ns / 1e9
+                      << " s (sidecar covers " << track_.begin_ns() / 1e9 << " – "
+                      << track_.end_ns() / 1e9 << " s); passing frames through.\n";
+        }
+        has_prev_ = false;
+        prev_spec_.release();
+        ++frame_idx_;
+        return out;
+    }
+    const Quaternion camera = body * mount;
+
+    if (!has_prev_) {
+        smoothed_          = camera;
+        residual_traj_     = {};
+        residual_smoothed_ = {};
+    }
+
+    // ── Residual image motion the attitude does not explain ──────────────────
+    if (refine) {
+        const cv::Matx33d prev_from_curr =
+            has_prev_ ? K_ * previous_.to_rotation().t() * camera.to_rotation() * K_inv_
+                      : cv::Matx33d::eye();
+        residual_traj_    += residual_shift(frame, prev_from_curr);
+        residual_smoothed_ = alpha * residual_smoothed_ + (1.0 - alpha) * residual_traj_;
+    }
+
+    previous_ = camera;
+    has_prev_ = true;
+
+    // ── Smoothed orientation and correction ──────────────────────────────────
+    smoothed_ = slerp(smoothed_, camera, 1.0 - alpha);
+    const cv::Point2d residual = residual_smoothed_ - residual_traj_;
+    const cv::Matx33d warp = translation(residual.x, residual.y) *
+                             K_ * smoothed_.to_rotation().t() * camera.to_rotation() * K_inv_;
+
+    if (deferred_warp_) {
+        // The cropper resamples only its ROI through this warp
+        out.warp_pending = true;
+        out.warp         = warp;
+        out.warp_affine  = false;
+        out.border_mode  = cv::BORDER_REFLECT;
+    } else {
+        out.data = warp_image(frame.data, frame.format, warp, size, false, cv::BORDER_REFLECT);
+    }
+
+    std::vector<cv::Point2f> center_in  = { out.suggested_center };
+    std::vector<cv::Point2f> center_out;
+    cv::perspectiveTransform(center_in, center_out, warp);
+    out.suggested_center = {
+        std::max(0.f, std::min(center_out[0].x, static_cast<float>(size.width - 1))),
+        std::max(0.f, std::min(center_out[0].y, static_cast<float>(size.height - 1)))
+    };
+
+    if (frame_idx_ % 30 == 0) {
+        std::cout << "[TelemetryStabilizer] Frame " << frame_idx_
+                  << " | correction " << angle_deg(smoothed_.conjugate() * camera) << "°";
+        if (refine) {
+            std::cout << " | residual (" << residual.x << ", " << residual.y
+                      << ") px, response " << last_response_
+                      << " | low-response frames: " << low_response_;
+        }
+        std::cout << " | uncovered frames: " << uncovered_ << "\n";
+    }
+
+    ++frame_idx_;
+    return out;
+}
@@ -0,0 +1,102 @@
+#pragma once
+
+#include "interfaces.h"
+#include "Geometry/PhaseCorrelator.h"
+#include "Telemetry/AttitudeTrack.h"
+
+#include <cstddef>
+#include <cstdint>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// TelemetryStabilizer
+//
+// Stabilization from the recorded attitude instead of the image: the
+// attitude/gyro sidecar is interpolated at each frame's pts_ns and the
+// rotation between the actual and the smoothed camera orientation is
+// applied as the homography H = K · R_smoothedᵀ · R_camera · K⁻¹. No
+// features are extracted or matched.
+//
+//   init("hfov_deg=48,time_offset_ms=-12", "pass_0412.attitude.csv")
+//
+// Design:
+//   - model_weights is the sidecar path (formats: see AttitudeTrack)
+//   - Pinhole intrinsics: fx/fy/cx/cy in pixels of the incoming frames, or
+//     derived from hfov_deg (square pixels, centred principal point)
+//   - The sidecar's attitude is the body's; mount_* is the camera → body
+//     rotation (identity: camera axes x right, y down, z along the view)
+//   - Smoothing as in OFStabilizer (exponential, alpha), but on the
+//     orientation itself via slerp, so there is no angle wrap-around and
+//     all three axes are smoothed together
+//   - Optional visual refinement (refine): the previous frame is predicted
+//     from the attitude change, and phase correlation of small luma images
+//     measures the translation that is left (timing error, gyro drift,
+//     parallax). That residual is smoothed and corrected like a 2-D
+//     trajectory
+//   - Frames the sidecar does not cover pass through unwarped and are
+//     counted; smoothing restarts from the next covered frame
+// ─────────────────────────────────────────────────────────────────────────────
+
+class TelemetryStabilizer : public IVideoStabilizer {
+public:
+    double     hfov_deg       = 60.0;   // used when fx is not given
+    double     fx = 0, fy = 0;          // px; 0 → from hfov_deg
+    double     cx = -1, cy = -1;        // px; negative → frame centre
+    double     time_offset_ms = 0.0;    // sidecar time = pts + offset
+    Quaternion mount;                   // camera → body
+    double     alpha          = 0.9;    // orientation smoothing, as OFStabilizer
+
+    bool       refine         = false;  // phase-correlation residual correction
+    int        refine_width   = 256;    // px, before DFT-size rounding
+    double     min_response   = 0.05;   // correlation peak height, 0..1
+
+    TelemetryStabilizer()  = default;
+    ~TelemetryStabilizer() override = default;
+
+    // model_config may override the fields above (mount as mount_qw,
+    // mount_qx, mount_qy, mount_qz); model_weights is the sidecar file.
+    bool init(const std::string& model_config  = "",
+              const std::string& model_weights = "") override;
+
+    StabilizedFrame stabilize(const RawFrame&        frame,
+                              const DetectionResult& detection) override;
+
+    void flush() override {}
+
+    void set_deferred_warp(bool enable) override { deferred_warp_ = enable; }
+
+private:
+    // Intrinsics and refinement buffers for a new input resolution.
+    void configure(cv::Size frame_size);
+
+    // Residual translation (frame px) of `frame` against the previous one
+    // after removing the rotation `prev_from_curr`; zero when unreliable.
+    cv::Point2d residual_shift(const RawFrame& frame, const cv::Matx33d& prev_from_curr);
+
+    AttitudeTrack track_;
+
+    // ── Camera ───────────────────────────────────────────────────────────────
+    cv::Size    frame_size_;
+    cv::Matx33d K_     = cv::Matx33d::eye();
+    cv::Matx33d K_inv_ = cv::Matx33d::eye();
+
+    // ── Orientation state ────────────────────────────────────────────────────
+    Quaternion  previous_;               // camera → reference, last frame
+    Quaternion  smoothed_;
+    bool        has_prev_ = false;
+
+    // ── Refinement ───────────────────────────────────────────────────────────
+    cv::Size        analysis_size_;
+    int             level_ = 0;          // frame pyramid level resized from
+    double          analysis_scale_ = 1.0;
+    PhaseCorrelator correlator_;
+    cv::Mat         resized_, small_, predicted_;
+    cv::Mat         curr_spec_, prev_spec_;
+    cv::Point2d     residual_traj_;
+    cv::Point2d     residual_smoothed_;
+
+    double      last_response_ = 0.0;
+    std::size_t low_response_  = 0;
+    std::size_t uncovered_     = 0;
+    std::size_t frame_idx_     = 0;
+    bool        deferred_warp_ = false;
+};
@@ -0,0 +1,254 @@
+#include "Telemetry/AttitudeTrack.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Quaternion
+// ─────────────────────────────────────────────────────────────────────────────
+
+Quaternion Quaternion::normalized() const
+{
+    const double n = std::sqrt(w * w + x * x + y * y + z * z);
+    if (n < 1e-12) return {};
+    return { w / n, x / n, y / n, z / n };
+}
+
+Quaternion Quaternion::from_axis_angle(const cv::Vec3d& axis, double angle)
+{
+    const double s = std::sin(0.5 * angle);
+    return { std::cos(0.5 * angle), axis[0] * s, axis[1] * s, axis[2] * s };
+}
+
+cv::Matx33d Quaternion::to_rotation() const
+{
+    return cv::Matx33d(
+        1 - 2 * (y * y + z * z),     2 * (x * y - w * z),     2 * (x * z + w * y),
+            2 * (x * y + w * z), 1 - 2 * (x * x + z * z),     2 * (y * z - w * x),
+            2 * (x * z - w * y),     2 * (y * z + w * x), 1 - 2 * (x * x + y * y));
+}
+
+Quaternion operator*(const Quaternion& a, const Quaternion& b)
+{
+    return { a.w * b.w - a.x * b.x - a.y * b.y - a.z * b.z,
+             a.w * b.x + a.x * b.w + a.y * b.z - a.z * b.y,
+             a.w * b.y - a.x * b.z + a.y * b.w + a.z * b.x,
+             a.w * b.z + a.x * b.y - a.y * b.x + a.z * b.w };
+}
+
+Quaternion slerp(const Quaternion& a, const Quaternion& b, double t)
+{
+    double     cos_theta = a.w * b.w + a.x * b.x + a.y * b.y + a.z * b.z;
+    Quaternion to        = b;
+    if (cos_theta < 0.0) {
+        cos_theta = -cos_theta;
+        to        = { -b.w, -b.x, -b.y, -b.z };
+    }
+
+    // Nearly parallel: linear interpolation is exact enough and stable
+    double wa = 1.0 - t, wb = t;
+    if (cos_theta < 0.9995) {
+        const double theta = std::acos(cos_theta);
+        const double inv   = 1.0 / std::sin(theta);
+        wa = std::sin((1.0 - t) * theta) * inv;
+        wb = std::sin(t * theta) * inv;
+    }
+    return Quaternion{ wa * a.w + wb * to.w, wa * a.x + wb * to.x,
+                       wa * a.y + wb * to.y, wa * a.z + wb * to.z }.normalized();
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Loading
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool AttitudeTrack::load(const std::string& path)
+{
+    times_.clear();
+    attitudes_.clear();
+    cursor_ = 0;
+
+    const bool binary = path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0;
+    if (!(binary ? load_binary(path) : load_csv(path))) {
+        times_.clear();
+        attitudes_.clear();
+        return false;
+    }
+
+    finalize();
+    if (times_.size() < 2) {
+        std::cerr << "[AttitudeTrack] " << path << ": fewer than two samples.\n";
+        times_.clear();
+        attitudes_.clear();
+        return false;
+    }
+
+    std::cout << "[AttitudeTrack] " << times_.size() << " samples, "
+              << (times_.back() - times_.front()) / 1e9 << " s from " << path << "\n";
+    return true;
+}
+
+bool AttitudeTrack::load_csv(const std::string& path)
+{
+    std::ifstream in(path);
+    if (!in) {
+        std::cerr << "[AttitudeTrack] Cannot open " << path << "\n";
+        return false;
+    }
+
+    std::vector<cv::Vec3d> rates;   // gyro files only
+    std::size_t columns = 0;        // fixed by the first data line
+    std::size_t skipped = 0;
+    std::string line;
+    for (std::size_t line_no = 1; std::getline(in, line); ++line_no) {
+        const auto hash = line.find('#');
+        if (hash != std::string::npos) line.erase(hash);
+        std::replace(line.begin(), line.end(), ',', ' ');
+
+        if (line.find_first_not_of(" \t\r") == std::string::npos) continue;
+
+        std::istringstream  ss(line);
+        long long           t = 0;
+        std::vector<double> values;
+        if (!(ss >> t)) { ++skipped; continue; }   // header / garbage
+        for (double v; ss >> v;) values.push_back(v);
+        if (!ss.eof()) { ++skipped; continue; }
+
+        if (columns == 0) {
+            if (values.size() != 3 && values.size() != 4) {
+                std::cerr << "[AttitudeTrack] " << path << ":" << line_no
+                          << ": expected t_ns + 4 quaternion or 3 gyro columns, got "
+                          << values.size() + 1 << ".\n";
+                return false;
+            }
+            columns = values.size();
+        }
+        if (values.size() != columns) { ++skipped; continue; }
+
+        times_.push_back(t);
+        if (columns == 4) {
+            attitudes_.push_back({ values[0], values[1], values[2], values[3] });
+        } else {
+            rates.emplace_back(values[0], values[1], values[2]);
+        }
+    }
+
+    // A header line is expected; anything more is worth a warning
+    if (skipped > 1) {
+        std::cerr << "[AttitudeTrack] " << path << ": skipped " << skipped
+                  << " unparsable lines.\n";
+    }
+
+    if (columns == 3) {
+        // Integrate body rates (trapezoidal) from the identity attitude
+        std::vector<std::size_t> order(times_.size());
+        std::iota(order.begin(), order.end(), std::size_t{ 0 });
+        std::stable_sort(order.begin(), order.end(),
+                         [&](std::size_t a, std::size_t b) { return times_[a] < times_[b]; });
+
+        std::vector<std::int64_t> times;
+        times.reserve(order.size());
+        attitudes_.reserve(order.size());
+        Quaternion q;
+        for (std::size_t k = 0; k < order.size(); ++k) {
+            if (k > 0) {
+                const double    dt    = (times_[order[k]] - times_[order[k - 1]]) * 1e-9;
+                const cv::Vec3d omega = 0.5 * (rates[order[k]] + rates[order[k - 1]]);
+                const double    rate  = cv::norm(omega);
+                if (rate * dt > 1e-12) {
+                    q = (q * Quaternion::from_axis_angle(omega * (1.0 / rate), rate * dt))
+                            .normalized();
+                }
+            }
+            times.push_back(times_[order[k]]);
+            attitudes_.push_back(q);
+        }
+        times_ = std::move(times);
+    }
+    return true;
+}
+
+bool AttitudeTrack::load_binary(const std::string& path)
+{
+    std::ifstream in(path, std::ios::binary);
+    if (!in) {
+        std::cerr << "[AttitudeTrack] Cannot open " << path << "\n";
+        return false;
+    }
+
+    constexpr std::size_t kRecord = sizeof(std::int64_t) + 4 * sizeof(double);
+    char buffer[kRecord];
+    while (in.read(buffer, kRecord)) {
+        std::int64_t t;
+        double       q[4];
+        std::memcpy(&t, buffer, sizeof(t));
+        std::memcpy(q, buffer + sizeof(t), sizeof(q));
+        times_.push_back(t);
+        attitudes_.push_back({ q[0], q[1], q[2], q[3] });
+    }
+    if (in.gcount() != 0) {
+        std::cerr << "[AttitudeTrack] " << path << ": ignoring a truncated trailing record.\n";
+    }
+    return true;
+}
+
+void AttitudeTrack::finalize()
+{
+    std::vector<std::size_t> order(times_.size());
+    std::iota(order.begin(), order.end(), std::size_t{ 0 });
+    std::stable_sort(order.begin(), order.end(),
+                     [&](std::size_t a, std::size_t b) { return times_[a] < times_[b]; });
+
+    std::vector<std::int64_t> times;
+    std::vector<Quaternion>   attitudes;
+    times.reserve(order.size());
+    attitudes.reserve(order.size());
+    for (std::size_t i : order) {
+        if (!times.empty() && times.back() == times_[i]) continue;
+
+        Quaternion q = attitudes_[i].normalized();
+        // q and -q are the same attitude; keep the track continuous
+        if (!attitudes.empty()) {
+            const Quaternion& p = attitudes.back();
+            if (p.w * q.w + p.x * q.x + p.y * q.y + p.z * q.z < 0.0) q = { -q.w, -q.x, -q.y, -q.z };
+        }
+        times.push_back(times_[i]);
+        attitudes.push_back(q);
+    }
+    times_     = std::move(times);
+    attitudes_ = std::move(attitudes);
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Lookup
+// ─────────────────────────────────────────────────────────────────────────────
+
+bool AttitudeTrack::at(std::int64_t t_ns, Quaternion& q) const
+{
+    if (times_.size() < 2 || t_ns < times_.front() || t_ns > times_.back()) return false;
+
+    // Interval [i, i + 1] containing t_ns: the cached one or its successor
+    // in the common case, else a binary search
+    std::size_t i = std::min(cursor_, times_.size() - 2);
+    if (!(times_[i] <= t_ns && t_ns <= times_[i + 1])) {
+        if (i + 2 < times_.size() && times_[i + 1] <= t_ns && t_ns <= times_[i + 2]) {
+            ++i;
+        } else {
+            const auto it = std::upper_bound(times_.begin(), times_.end(), t_ns);
+            i = std::min<std::size_t>(static_cast<std::size_t>(it - times_.begin()),
+                                      times_.size() - 1) - 1;
+        }
+    }
+    cursor_ = i;
+
+    const std::int64_t span = times_[i + 1] - times_[i];
+    if (span > max_gap_ns) return false;
+
+    const double t = static_cast<double>(t_ns - times_[i]) / static_cast<double>(span);
+    q = slerp(attitudes_[i], attitudes_[i + 1], t);
+    return true;
+}
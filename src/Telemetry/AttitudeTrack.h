@@ -0,0 +1,92 @@
+#pragma once
+
+#include <opencv2/core.hpp>
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Quaternion
+//
+// Unit quaternion (w, x, y, z) for attitudes: rotation from the body
+// (camera) frame to the reference frame, Hamilton convention.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct Quaternion {
+    double w = 1.0, x = 0.0, y = 0.0, z = 0.0;
+
+    Quaternion conjugate() const { return { w, -x, -y, -z }; }
+    Quaternion normalized() const;
+
+    // Rotation by `angle` (radians) about the unit `axis`.
+    static Quaternion from_axis_angle(const cv::Vec3d& axis, double angle);
+
+    // 3x3 rotation matrix R with v_ref = R · v_body.
+    cv::Matx33d to_rotation() const;
+};
+
+Quaternion operator*(const Quaternion& a, const Quaternion& b);
+
+// Shortest-path spherical interpolation, t ∈ [0, 1].
+Quaternion slerp(const Quaternion& a, const Quaternion& b, double t);
+
+// ─────────────────────────────────────────────────────────────────────────────
+// AttitudeTrack
+//
+// Timestamped attitude samples from a sidecar file recorded next to the
+// video, queried at frame timestamps.
+//
+//   AttitudeTrack track;
+//   track.load("pass_0412.attitude.csv");
+//   Quaternion q;
+//   if (track.at(frame.pts_ns + offset_ns, q)) ...
+//
+// Formats (chosen by content / extension):
+//   - CSV, quaternions:  t_ns, qw, qx, qy, qz
+//   - CSV, gyro rates:   t_ns, wx, wy, wz      (rad/s, body frame)
+//     integrated at load time from the identity attitude, so only
+//     relative attitude is known — which is all stabilization needs
+//   - ".bin": packed little-endian records { int64 t_ns; float64 qw, qx,
+//     qy, qz } (40 bytes), as written by the on-board logger
+//   CSV fields may be separated by commas or whitespace; blank lines,
+//   '#' comments and a non-numeric header line are skipped.
+//
+// Design:
+//   - Samples are sorted by time once; at() interpolates with slerp
+//     between the two neighbouring samples
+//   - Frames arrive in timestamp order, so at() starts its search from the
+//     previous interval and only falls back to a binary search on jumps
+//   - Timestamps outside the track, or inside a gap longer than max_gap_ns,
+//     are reported as uncovered rather than extrapolated
+// ─────────────────────────────────────────────────────────────────────────────
+
+class AttitudeTrack {
+public:
+    std::int64_t max_gap_ns = 200'000'000;   // longest interval interpolated over
+
+    // Replace the track with the samples in `path`. False (and an empty
+    // track) if the file cannot be read or holds fewer than two samples.
+    bool load(const std::string& path);
+
+    // Attitude at `t_ns`; false if `t_ns` is not covered.
+    bool at(std::int64_t t_ns, Quaternion& q) const;
+
+    std::size_t  size()  const { return times_.size(); }
+    bool         empty() const { return times_.empty(); }
+    std::int64_t begin_ns() const { return times_.empty() ? 0 : times_.front(); }
+    std::int64_t end_ns()   const { return times_.empty() ? 0 : times_.back(); }
+
+private:
+    bool load_csv(const std::string& path);
+    bool load_binary(const std::string& path);
+
+    // Sort by time, drop duplicate timestamps, normalize, keep neighbouring
+    // quaternions in the same hemisphere.
+    void finalize();
+
+    std::vector<std::int64_t> times_;
+    std::vector<Quaternion>   attitudes_;
+    mutable std::size_t       cursor_ = 0;   // last interval used by at()
+};
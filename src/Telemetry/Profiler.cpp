@@ -0,0 +1,266 @@
+#include "Telemetry/Profiler.h"
+
+#include <algorithm>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+
+namespace {
+
+constexpr double kFrameBudgetMs = 1000.0 / 30.0;
+
+double to_ms(std::uint64_t ns) { return static_cast<double>(ns) / 1e6; }
+
+int highest_bit(std::uint64_t v)
+{
+    return 63 - __builtin_clzll(v);
+}
+
+void write_json_string(std::ostream& os, const std::string& s)
+{
+    os << '"';
+    for (char c : s) {
+        if (c == '"' || c == '\\') os << '\\';
+        os << c;
+    }
+    os << '"';
+}
+
+} // namespace
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Histogram
+//
+// Values below 8 ns get one bucket each; above that every power of two is
+// split into 8 linear sub-buckets:  bucket = (msb - 2) * 8 + next 3 bits.
+// ─────────────────────────────────────────────────────────────────────────────
+
+int Profiler::Histogram::bucket_of(std::uint64_t ns)
+{
+    if (ns < static_cast<std::uint64_t>(kSubCount)) {
+        return static_cast<int>(ns);
+    }
+    const int msb = highest_bit(ns);
+    const int sub = static_cast<int>((ns >> (msb - kSubBits)) & (kSubCount - 1));
+    return (msb - kSubBits + 1) * kSubCount + sub;
+}
+
+std::uint64_t Profiler::Histogram::upper_bound_of(int bucket)
+{
+    if (bucket < kSubCount) {
+        return static_cast<std::uint64_t>(bucket);
+    }
+    const int           msb   = bucket / kSubCount + kSubBits - 1;
+    const std::uint64_t sub   = static_cast<std::uint64_t>(bucket % kSubCount);
+    const std::uint64_t step  = std::uint64_t{ 1 } << (msb - kSubBits);
+    const std::uint64_t lower = (static_cast<std::uint64_t>(kSubCount) + sub) * step;
+    return lower + (step - 1);
+}
+
+void Profiler::Histogram::add(std::uint64_t ns)
+{
+    ++buckets_[bucket_of(ns)];
+    ++count_;
+    sum_ += ns;
+    max_  = std::max(max_, ns);
+}
+
+void Profiler::Histogram::merge(const Histogram& other)
+{
+    for (int i = 0; i < kBuckets; ++i) {
+        buckets_[i] += other.buckets_[i];
+    }
+    count_ += other.count_;
+    sum_   += other.sum_;
+    max_    = std::max(max_, other.max_);
+}
+
+std::uint64_t Profiler::Histogram::percentile(double p) const
+{
+    if (count_ == 0) return 0;
+
+    const auto target = static_cast<std::uint64_t>(
+        std::ceil(std::clamp(p, 0.0, 1.0) * static_cast<double>(count_)));
+
+    std::uint64_t seen = 0;
+    for (int i = 0; i < kBuckets; ++i) {
+        seen += buckets_[i];
+        if (seen >= target && seen > 0) {
+            return std::min(upper_bound_of(i), max_);
+        }
+    }
+    return max_;
+}
+
+double Profiler::Histogram::mean() const
+{
+    return count_ > 0 ? static_cast<double>(sum_) / static_cast<double>(count_) : 0.0;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Profiler
+// ─────────────────────────────────────────────────────────────────────────────
+
+Profiler::Profiler()
+    : epoch_(Clock::now())
+{
+}
+
+Profiler& Profiler::instance()
+{
+    static Profiler profiler;
+    return profiler;
+}
+
+void Profiler::enable_trace(const std::string& path, std::size_t max_events_per_thread)
+{
+    trace_path_ = path;
+    max_events_ = max_events_per_thread;
+}
+
+std::uint64_t Profiler::now_ns() const
+{
+    return static_cast<std::uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(
+            Clock::now() - epoch_).count());
+}
+
+Profiler::ThreadBuffer& Profiler::local_buffer()
+{
+    // The registry keeps a reference too, so a stage's data survives the
+    // thread exiting before report() runs.
+    thread_local std::shared_ptr<ThreadBuffer> buffer;
+    if (!buffer) {
+        buffer = std::make_shared<ThreadBuffer>();
+
+        std::lock_guard<std::mutex> lock(registry_mutex_);
+        buffer->tid = static_cast<int>(buffers_.size()) + 1;
+        buffers_.push_back(buffer);
+    }
+    return *buffer;
+}
+
+void Profiler::set_thread_name(const std::string& name)
+{
+    ThreadBuffer& buf = local_buffer();
+    std::lock_guard<std::mutex> lock(buf.mutex);
+    buf.name = name;
+}
+
+void Profiler::record(const char* name, std::uint64_t start_ns, std::uint64_t duration_ns)
+{
+    ThreadBuffer& buf = local_buffer();
+    std::lock_guard<std::mutex> lock(buf.mutex);   // uncontended outside report()
+
+    auto it = std::find_if(buf.histograms.begin(), buf.histograms.end(),
+                           [name](const auto& h) { return h.first == name; });
+    if (it == buf.histograms.end()) {
+        buf.histograms.emplace_back(name, Histogram{});
+        it = std::prev(buf.histograms.end());
+    }
+    it->second.add(duration_ns);
+
+    if (tracing()) {
+        if (buf.events.size() < max_events_) {
+            buf.events.push_back({ name, start_ns, duration_ns });
+        } else {
+            ++buf.dropped_events;
+        }
+    }
+}
+
+void Profiler::report(std::ostream& os) const
+{
+    // Merge by name — the same scope may run on several threads, and equal
+    // literals in different translation units need not share an address.
+    std::map<std::string, Histogram> merged;
+    {
+        std::lock_guard<std::mutex> reg(registry_mutex_);
+        for (const auto& buf : buffers_) {
+            std::lock_guard<std::mutex> lock(buf->mutex);
+            for (const auto& [name, hist] : buf->histograms) {
+                merged[name].merge(hist);
+            }
+        }
+    }
+
+    if (merged.empty()) return;
+
+    os << "[Profiler] Stage latency (ms), frame budget "
+       << std::fixed << std::setprecision(1) << kFrameBudgetMs << " ms:\n"
+       << "  " << std::left << std::setw(14) << "scope" << std::right
+       << std::setw(9) << "count"
+       << std::setw(9) << "mean"
+       << std::setw(9) << "p50"
+       << std::setw(9) << "p95"
+       << std::setw(9) << "p99"
+       << std::setw(9) << "max" << "\n";
+
+    os << std::setprecision(2);
+    for (const auto& [name, h] : merged) {
+        const double p99 = to_ms(h.percentile(0.99));
+        os << "  " << std::left << std::setw(14) << name << std::right
+           << std::setw(9) << h.count()
+           << std::setw(9) << h.mean() / 1e6
+           << std::setw(9) << to_ms(h.percentile(0.50))
+           << std::setw(9) << to_ms(h.percentile(0.95))
+           << std::setw(9) << p99
+           << std::setw(9) << to_ms(h.max())
+           << (p99 > kFrameBudgetMs ? "  ← over budget" : "") << "\n";
+    }
+    os << std::defaultfloat;
+}
+
+bool Profiler::write_trace() const
+{
+    if (!tracing()) return true;
+
+    std::ofstream out(trace_path_);
+    if (!out) {
+        std::cerr << "[Profiler] Cannot open trace file: " << trace_path_ << "\n";
+        return false;
+    }
+
+    std::size_t   written = 0;
+    std::uint64_t dropped = 0;
+    bool          first   = true;
+    auto sep = [&]() -> std::ostream& {
+        if (!first) out << ",\n";
+        first = false;
+        return out;
+    };
+
+    out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n";
+    out << std::fixed << std::setprecision(3);
+
+    std::lock_guard<std::mutex> reg(registry_mutex_);
+    for (const auto& buf : buffers_) {
+        std::lock_guard<std::mutex> lock(buf->mutex);
+
+        if (!buf->name.empty()) {
+            sep() << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":"
+                  << buf->tid << ",\"args\":{\"name\":";
+            write_json_string(out, buf->name);
+            out << "}}";
+        }
+        for (const TraceEvent& e : buf->events) {
+            sep() << "{\"name\":";
+            write_json_string(out, e.name);
+            out << ",\"cat\":\"pipeline\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buf->tid
+                << ",\"ts\":"  << static_cast<double>(e.start_ns)    / 1e3
+                << ",\"dur\":" << static_cast<double>(e.duration_ns) / 1e3 << "}";
+        }
+        written += buf->events.size();
+        dropped += buf->dropped_events;
+    }
+    out << "\n]}\n";
+
+    std::cout << "[Profiler] Wrote " << written << " trace events to " << trace_path_;
+    if (dropped > 0) {
+        std::cout << " (" << dropped << " dropped — per-thread cap reached)";
+    }
+    std::cout << "\n";
+    return static_cast<bool>(out);
+}
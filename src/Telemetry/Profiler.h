@@ -0,0 +1,140 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <iosfwd>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Profiler
+//
+// Low-overhead latency instrumentation for the pipeline stages.
+//
+//   {
+//       PROFILE_SCOPE("detect");
+//       detector->detect(frame);
+//   }
+//
+// Design:
+//   - Each thread records into its own buffer (created on first use and
+//     registered with the process-wide Profiler), so recording never
+//     contends with other stages; the per-buffer mutex is only ever taken
+//     by a second thread while report()/write_trace() run
+//   - Durations go into log-linear histograms (8 sub-buckets per power of
+//     two, ≤12.5% bucket error) — constant memory regardless of run length
+//   - With tracing enabled every scope is also kept as a Chrome trace
+//     "complete" event (capped per thread) and written as JSON loadable in
+//     Perfetto / chrome://tracing
+//   - Scope names must be string literals (or otherwise outlive the
+//     Profiler) — only the pointer is stored on the hot path
+// ─────────────────────────────────────────────────────────────────────────────
+
+class Profiler {
+public:
+    // Latency distribution of one named scope.
+    class Histogram {
+    public:
+        static constexpr int kSubBits   = 3;
+        static constexpr int kSubCount  = 1 << kSubBits;
+        static constexpr int kBuckets   = 64 * kSubCount;
+
+        void          add(std::uint64_t ns);
+        void          merge(const Histogram& other);
+        std::uint64_t percentile(double p) const;   // bucket upper bound, ns
+
+        std::uint64_t count() const { return count_; }
+        std::uint64_t max()   const { return max_; }
+        double        mean()  const;
+
+    private:
+        static int           bucket_of(std::uint64_t ns);
+        static std::uint64_t upper_bound_of(int bucket);
+
+        std::array<std::uint64_t, kBuckets> buckets_{};
+        std::uint64_t count_ = 0;
+        std::uint64_t sum_   = 0;
+        std::uint64_t max_   = 0;
+    };
+
+    static Profiler& instance();
+
+    // Keep every scope as a trace event; write_trace() dumps them to `path`.
+    // Call before the pipeline starts. Empty path disables tracing.
+    void enable_trace(const std::string& path, std::size_t max_events_per_thread = 1 << 20);
+    bool tracing() const { return !trace_path_.empty(); }
+
+    // Label the calling thread in the trace (e.g. "detect").
+    void set_thread_name(const std::string& name);
+
+    // Record one finished scope for the calling thread.
+    void record(const char* name, std::uint64_t start_ns, std::uint64_t duration_ns);
+
+    // Nanoseconds since the Profiler was created (trace time base).
+    std::uint64_t now_ns() const;
+
+    // Per-scope count / mean / p50 / p95 / p99 / max, merged over all threads.
+    void report(std::ostream& os) const;
+
+    // Write the Chrome trace JSON. No-op (returns true) when tracing is off.
+    bool write_trace() const;
+
+private:
+    struct TraceEvent {
+        const char*   name;
+        std::uint64_t start_ns;
+        std::uint64_t duration_ns;
+    };
+
+    struct ThreadBuffer {
+        std::mutex                                    mutex;
+        int                                           tid = 0;
+        std::string                                   name;
+        std::vector<std::pair<const char*, Histogram>> histograms;
+        std::vector<TraceEvent>                       events;
+        std::uint64_t                                 dropped_events = 0;
+    };
+
+    Profiler();
+    ThreadBuffer& local_buffer();
+
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point epoch_;
+    std::string       trace_path_;
+    std::size_t       max_events_ = 0;
+
+    mutable std::mutex                          registry_mutex_;
+    std::vector<std::shared_ptr<ThreadBuffer>>  buffers_;
+};
+
+// ─────────────────────────────────────────────────────────────────────────────
+// ScopedTimer — records the lifetime of the enclosing scope.
+// ─────────────────────────────────────────────────────────────────────────────
+
+class ScopedTimer {
+public:
+    explicit ScopedTimer(const char* name)
+        : name_(name), start_ns_(Profiler::instance().now_ns()) {}
+
+    ~ScopedTimer()
+    {
+        Profiler& p = Profiler::instance();
+        p.record(name_, start_ns_, p.now_ns() - start_ns_);
+    }
+
+    ScopedTimer(const ScopedTimer&)            = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    const char*   name_;
+    std::uint64_t start_ns_;
+};
+
+#define PROFILE_CONCAT_INNER(a, b) a##b
+#define PROFILE_CONCAT(a, b)       PROFILE_CONCAT_INNER(a, b)
+#define PROFILE_SCOPE(name)        ScopedTimer PROFILE_CONCAT(profile_scope_, __LINE__)(name)
@@ -1,8 +1,170 @@
 #include "VideoInputStream/gstreamervideo.h"
 
+#include <gst/video/video.h>
+
+#include <algorithm>
+#include <cstring>
 #include <iostream>
 #include <stdexcept>
 
+namespace {
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Zero-copy support
+//
+// A MatAllocator whose UMatData owns a mapped GstSample. OpenCV calls
+// deallocate() once the last cv::Mat sharing the data is released, which is
+// where we unmap the buffer and drop our sample ref.
+// ─────────────────────────────────────────────────────────────────────────────
+
+struct MappedSample {
+    GstSample* sample = nullptr;
+    GstBuffer* buffer = nullptr;
+    GstMapInfo map{};
+};
+
+class GstSampleAllocator : public cv::MatAllocator {
+public:
+    // Wrapped Mats never allocate through us (Mat::allocator stays null), but
+    // the interface requires these — defer to OpenCV's standard allocator.
+    cv::UMatData* allocate(int dims, const int* sizes, int type, void* data,
+                           size_t* step, cv::AccessFlag flags,
+                           cv::UMatUsageFlags usage) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate(dims, sizes, type, data,
+                                                    step, flags, usage);
+    }
+
+    bool allocate(cv::UMatData* u, cv::AccessFlag flags,
+                  cv::UMatUsageFlags usage) const override
+    {
+        return cv::Mat::getStdAllocator()->allocate(u, flags, usage);
+    }
+
+    void deallocate(cv::UMatData* u) const override
+    {
+        if (!u) return;
+        auto* mapped = static_cast<MappedSample*>(u->userdata);
+        gst_buffer_unmap(mapped->buffer, &mapped->map);
+        gst_sample_unref(mapped->sample);
+        delete mapped;
+        delete u;
+    }
+};
+
+const GstSampleAllocator& sample_allocator()
+{
+    static const GstSampleAllocator allocator;
+    return allocator;
+}
+
+// Map `sample` read-only and return a Mat that keeps it alive.
+cv::Mat wrap_sample(GstSample* sample, int rows, int cols, int type, size_t step)
+{
+    auto* mapped   = new MappedSample;
+    mapped->sample = gst_sample_ref(sample);
+    mapped->buffer = gst_sample_get_buffer(sample);
+
+    if (!gst_buffer_map(mapped->buffer, &mapped->map, GST_MAP_READ)) {
+        gst_sample_unref(mapped->sample);
+        delete mapped;
+        throw std::runtime_error("Failed to map GstBuffer.");
+    }
+    if (mapped->map.size < step * static_cast<size_t>(rows)) {
+        gst_buffer_unmap(mapped->buffer, &mapped->map);
+        gst_sample_unref(mapped->sample);
+        delete mapped;
+        throw std::runtime_error("GstBuffer smaller than caps imply.");
+    }
+
+    cv::Mat view(rows, cols, type, mapped->map.data, step);
+
+    auto* u     = new cv::UMatData(&sample_allocator());
+    u->data     = mapped->map.data;
+    u->origdata = mapped->map.data;
+    u->size     = mapped->map.size;
+    u->userdata = mapped;
+
+    view.u = u;
+    view.addref();          // refcount 0 → 1; the last release() calls deallocate()
+    return view;
+}
+
+// Deep-copy `rows` x `cols` pixels out of `buffer`.
+cv::Mat copy_buffer(GstBuffer* buffer, int rows, int cols, int type, size_t step)
+{
+    GstMapInfo map{};
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        throw std::runtime_error("Failed to map GstBuffer.");
+    }
+    if (map.size < step * static_cast<size_t>(rows)) {
+        gst_buffer_unmap(buffer, &map);
+        throw std::runtime_error("GstBuffer smaller than caps imply.");
+    }
+
+    cv::Mat view(rows, cols, type, map.data, step);
+    cv::Mat copy = view.clone();           // deep copy before we unmap
+
+    gst_buffer_unmap(buffer, &map);
+    return copy;
+}
+
+// True when the three I420 planes already sit back-to-back without row
+// padding, i.e. the buffer is exactly our packed (h*3/2) x w layout.
+bool is_packed_i420(const GstVideoInfo& info)
+{
+    const int    w = GST_VIDEO_INFO_WIDTH(&info);
+    const int    h = GST_VIDEO_INFO_HEIGHT(&info);
+    const size_t y = static_cast<size_t>(w) * h;
+
+    return w % 2 == 0 && h % 2 == 0
+        && GST_VIDEO_INFO_PLANE_STRIDE(&info, 0) == w
+        && GST_VIDEO_INFO_PLANE_STRIDE(&info, 1) == w / 2
+        && GST_VIDEO_INFO_PLANE_STRIDE(&info, 2) == w / 2
+        && GST_VIDEO_INFO_PLANE_OFFSET(&info, 0) == 0
+        && GST_VIDEO_INFO_PLANE_OFFSET(&info, 1) == y
+        && GST_VIDEO_INFO_PLANE_OFFSET(&info, 2) == y + y / 4;
+}
+
+// Copy a padded I420 buffer into the packed layout, row by row.
+cv::Mat repack_i420(GstBuffer* buffer, const GstVideoInfo& info)
+{
+    const int w = GST_VIDEO_INFO_WIDTH(&info);
+    const int h = GST_VIDEO_INFO_HEIGHT(&info);
+    if (w % 2 != 0 || h % 2 != 0) {
+        throw std::runtime_error("I420 frames must have even dimensions.");
+    }
+
+    GstMapInfo map{};
+    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+        throw std::runtime_error("Failed to map GstBuffer.");
+    }
+    if (map.size < GST_VIDEO_INFO_SIZE(&info)) {
+        gst_buffer_unmap(buffer, &map);
+        throw std::runtime_error("GstBuffer smaller than caps imply.");
+    }
+
+    cv::Mat packed(h * 3 / 2, w, CV_8UC1);
+    uchar*  dst = packed.data;
+
+    for (int plane = 0; plane < 3; ++plane) {
+        const int pw = plane == 0 ? w : w / 2;
+        const int ph = plane == 0 ? h : h / 2;
+        const uchar* src = map.data + GST_VIDEO_INFO_PLANE_OFFSET(&info, plane);
+        const int stride = GST_VIDEO_INFO_PLANE_STRIDE(&info, plane);
+
+        for (int r = 0; r < ph; ++r) {
+            std::memcpy(dst, src + static_cast<size_t>(r) * stride, pw);
+            dst += pw;
+        }
+    }
+
+    gst_buffer_unmap(buffer, &map);
+    return packed;
+}
+
+} // namespace
+
 // ─────────────────────────────────────────────────────────────────────────────
 // Public API
 // ─────────────────────────────────────────────────────────────────────────────
@@ -38,10 +200,15 @@ bool GstreamerCapture::start(const std::string& config)
     //   max-buffers=1 + drop=TRUE → always give us the latest frame
     //   sync=FALSE                → decode as fast as possible
     //   emit-signals=FALSE        → we use the pull model, not signals
+    //
+    // With prefetch the appsink instead blocks upstream when full and the
+    // decode thread drains it: Lossless never discards a frame, and
+    // LatestWins drops only in the ring, so frames_dropped counts them all.
+    const bool prefetch = prefetch_mode_ != PrefetchMode::Off;
     g_object_set(G_OBJECT(appsink_),
                  "emit-signals", FALSE,
-                 "max-buffers",  1,
-                 "drop",         TRUE,
+                 "max-buffers",  prefetch ? 2 : 1,
+                 "drop",         prefetch ? FALSE : TRUE,
                  "sync",         FALSE,
                  nullptr);
 
@@ -60,6 +227,24 @@ bool GstreamerCapture::start(const std::string& config)
 
     running_.store(true);
 
+    // ── Prefetch ring + decode thread ────────────────────────────────────────
+    if (prefetch_mode_ != PrefetchMode::Off) {
+        {
+            std::lock_guard<std::mutex> lock(ring_mutex_);
+            ring_.assign(prefetch_depth_, RawFrame{});
+            ring_head_     = 0;
+            ring_count_    = 0;
+            decode_done_   = false;
+            stats_         = Stats{};
+            occupancy_sum_ = 0.0;
+        }
+        decode_thread_ = std::thread(&GstreamerCapture::decode_loop, this);
+
+        std::cout << "[GstreamerCapture] Prefetch "
+                  << (prefetch_mode_ == PrefetchMode::Lossless ? "lossless" : "latest-wins")
+                  << ", ring depth " << prefetch_depth_ << ".\n";
+    }
+
     std::cout << "[GstreamerCapture] Pipeline started.\n";
     return true;
 }
@@ -68,9 +253,32 @@ void GstreamerCapture::stop()
 {
     running_.store(false);
 
+    // Wake a decode thread blocked on a full ring. Taking the lock first
+    // makes sure it is either already waiting or will see running_ == false.
+    { std::lock_guard<std::mutex> lock(ring_mutex_); }
+    ring_not_full_.notify_all();
+
+    // Going to NULL flushes the appsink, which unblocks a pending pull.
     if (pipeline_) {
         gst_element_set_state(pipeline_, GST_STATE_NULL);
     }
+    if (decode_thread_.joinable()) {
+        decode_thread_.join();
+
+        const Stats st = stats();
+        std::cout << "[GstreamerCapture] Prefetch: decoded " << st.frames_decoded
+                  << ", delivered " << st.frames_delivered
+                  << ", dropped "   << st.frames_dropped
+                  << " | decode stalls: "   << st.decode_stalls
+                  << ", consumer stalls: "  << st.consumer_stalls
+                  << " | queue peak "  << st.queue_peak << "/" << st.queue_capacity
+                  << ", mean " << st.queue_mean << "\n";
+
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        ring_.clear();
+        ring_head_  = 0;
+        ring_count_ = 0;
+    }
     if (bus_) {
         gst_object_unref(bus_);
         bus_ = nullptr;
@@ -87,7 +295,57 @@ void GstreamerCapture::stop()
     std::cout << "[GstreamerCapture] Pipeline stopped.\n";
 }
 
+void GstreamerCapture::interrupt()
+{
+    running_.store(false);
+
+    { std::lock_guard<std::mutex> lock(ring_mutex_); }
+    ring_not_full_.notify_all();
+
+    // Flushing the appsink makes a pending pull (ours or the decode
+    // thread's) return; the decode thread then marks the ring done, which
+    // wakes a consumer waiting for a frame. The GStreamer objects stay
+    // alive until stop(), so the woken pull can still use them.
+    if (pipeline_) {
+        gst_element_set_state(pipeline_, GST_STATE_NULL);
+    }
+}
+
 std::optional<RawFrame> GstreamerCapture::pull_frame()
+{
+    if (prefetch_mode_ != PrefetchMode::Off) {
+        return pull_from_ring();
+    }
+    return pull_from_appsink();
+}
+
+void GstreamerCapture::set_prefetch(PrefetchMode mode, std::size_t depth)
+{
+    if (running_.load()) {
+        std::cerr << "[GstreamerCapture] set_prefetch() ignored while running.\n";
+        return;
+    }
+    prefetch_mode_  = mode;
+    prefetch_depth_ = std::max<std::size_t>(depth, 1);
+}
+
+GstreamerCapture::Stats GstreamerCapture::stats() const
+{
+    std::lock_guard<std::mutex> lock(ring_mutex_);
+    Stats st          = stats_;
+    st.queue_size     = ring_count_;
+    st.queue_capacity = ring_.size();
+    st.queue_mean     = st.frames_delivered > 0
+                            ? occupancy_sum_ / static_cast<double>(st.frames_delivered)
+                            : 0.0;
+    return st;
+}
+
+// ─────────────────────────────────────────────────────────────────────────────
+// Private helpers
+// ─────────────────────────────────────────────────────────────────────────────
+
+std::optional<RawFrame> GstreamerCapture::pull_from_appsink()
 {
     if (!running_.load()) {
         return std::nullopt;
@@ -126,40 +384,137 @@ std::optional<RawFrame> GstreamerCapture::pull_frame()
     }
 }
 
-// ─────────────────────────────────────────────────────────────────────────────
-// Private helpers
-// ─────────────────────────────────────────────────────────────────────────────
+std::optional<RawFrame> GstreamerCapture::pull_from_ring()
+{
+    std::unique_lock<std::mutex> lock(ring_mutex_);
+
+    if (ring_count_ == 0 && !decode_done_) {
+        ++stats_.consumer_stalls;
+        ring_not_empty_.wait(lock, [this] { return ring_count_ > 0 || decode_done_; });
+    }
+    // Decode thread finished (EOS, error or stop) and the ring is drained.
+    if (ring_count_ == 0) {
+        return std::nullopt;
+    }
+
+    occupancy_sum_ += static_cast<double>(ring_count_);
+
+    RawFrame frame    = std::move(ring_[ring_head_]);
+    ring_[ring_head_] = RawFrame{};
+    ring_head_        = (ring_head_ + 1) % ring_.size();
+    --ring_count_;
+    ++stats_.frames_delivered;
+
+    lock.unlock();
+    ring_not_full_.notify_one();
+    return frame;
+}
+
+// Runs on decode_thread_ while prefetch is enabled.
+void GstreamerCapture::decode_loop()
+{
+    while (running_.load()) {
+        std::optional<RawFrame> frame = pull_from_appsink();
+        if (!frame.has_value()) {
+            break;                               // EOS, error or stop()
+        }
+
+        std::unique_lock<std::mutex> lock(ring_mutex_);
+        ++stats_.frames_decoded;
+
+        if (ring_count_ == ring_.size()) {
+            if (prefetch_mode_ == PrefetchMode::LatestWins) {
+                // Overwrite the oldest frame — the consumer wants fresh data.
+                ring_[ring_head_] = RawFrame{};
+                ring_head_        = (ring_head_ + 1) % ring_.size();
+                --ring_count_;
+                ++stats_.frames_dropped;
+            } else {
+                ++stats_.decode_stalls;
+                ring_not_full_.wait(lock, [this] {
+                    return ring_count_ < ring_.size() || !running_.load();
+                });
+                if (ring_count_ == ring_.size()) {
+                    break;                       // stop() while waiting
+                }
+            }
+        }
+
+        const std::size_t tail = (ring_head_ + ring_count_) % ring_.size();
+        ring_[tail] = std::move(*frame);
+        ++ring_count_;
+        stats_.queue_peak = std::max(stats_.queue_peak, ring_count_);
+
+        lock.unlock();
+        ring_not_empty_.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(ring_mutex_);
+        decode_done_ = true;
+    }
+    ring_not_empty_.notify_all();
+}
 
 RawFrame GstreamerCapture::buffer_to_frame(GstSample* sample) const
 {
-    GstBuffer*    buffer    = gst_sample_get_buffer(sample);
-    GstCaps*      caps      = gst_sample_get_caps(sample);
-    GstStructure* structure = gst_caps_get_structure(caps, 0);
+    GstBuffer* buffer = gst_sample_get_buffer(sample);
+    GstCaps*   caps   = gst_sample_get_caps(sample);
 
-    int width  = 0;
-    int height = 0;
-    gst_structure_get_int(structure, "width",  &width);
-    gst_structure_get_int(structure, "height", &height);
+    GstVideoInfo info;
+    if (!caps || !gst_video_info_from_caps(&info, caps)) {
+        throw std::runtime_error("Could not parse video caps.");
+    }
+
+    const int width  = GST_VIDEO_INFO_WIDTH(&info);
+    const int height = GST_VIDEO_INFO_HEIGHT(&info);
 
     if (width <= 0 || height <= 0) {
         throw std::runtime_error("Invalid frame dimensions from caps.");
     }
 
-    GstMapInfo map{};
-    if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-        throw std::runtime_error("Failed to map GstBuffer.");
-    }
+    RawFrame frame;
+    frame.pts_ns = static_cast<std::int64_t>(GST_BUFFER_PTS(buffer));
+
+    // Single-plane formats map straight onto a cv::Mat; the row stride
+    // comes from the caps (GStreamer pads RGB rows to 4 bytes).
+    auto single_plane = [&](int type) {
+        const size_t step = static_cast<size_t>(GST_VIDEO_INFO_PLANE_STRIDE(&info, 0));
+        return zero_copy_ ? wrap_sample(sample, height, width, type, step)
+                          : copy_buffer(buffer, height, width, type, step);
+    };
+
+    switch (GST_VIDEO_INFO_FORMAT(&info)) {
+        case GST_VIDEO_FORMAT_BGR:
+            frame.format = PixelFormat::BGR;
+            frame.data   = single_plane(CV_8UC3);
+            break;
 
-    // We request BGR from the pipeline (video/x-raw,format=BGR),
-    // so CV_8UC3 matches directly.
-    cv::Mat view(height, width, CV_8UC3, map.data);
+        case GST_VIDEO_FORMAT_GRAY8:
+            frame.format = PixelFormat::Gray;
+            frame.data   = single_plane(CV_8UC1);
+            break;
 
-    RawFrame frame;
-    frame.data   = view.clone();           // deep copy before we unmap
-    frame.pts_ns = static_cast<std::int64_t>(
-                       GST_BUFFER_PTS(buffer));
+        case GST_VIDEO_FORMAT_I420:
+            // Packed buffers are one (h*3/2) x w Mat — wrap or copy in one go.
+            // Padded ones (odd chroma strides) have to be repacked.
+            frame.format = PixelFormat::I420;
+            if (is_packed_i420(info)) {
+                frame.data = zero_copy_
+                    ? wrap_sample(sample, height * 3 / 2, width, CV_8UC1, width)
+                    : copy_buffer(buffer, height * 3 / 2, width, CV_8UC1, width);
+            } else {
+                frame.data = repack_i420(buffer, info);
+            }
+            break;
+
+        default:
+            throw std::runtime_error(
+                std::string("Unsupported pixel format ") +
+                gst_video_format_to_string(GST_VIDEO_INFO_FORMAT(&info)) +
+                " (expected BGR, GRAY8 or I420).");
+    }
 
-    gst_buffer_unmap(buffer, &map);
     return frame;
 }
 
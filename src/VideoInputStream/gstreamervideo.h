@@ -6,23 +6,62 @@
 #include <gst/app/gstappsink.h>
 
 #include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 // ─────────────────────────────────────────────────────────────────────────────
 // GstreamerCapture
 //
 // Implementation of IVideoInputStream using GStreamer.
-// Simplified implementation using the pull model — no queue, no mutex.
+// By default a simple pull model — no queue, no mutex.
 //
 // Design:
 //   - The pipeline includes videorate to decimate 60fps → 30fps upstream
 //   - pull_frame() directly calls gst_app_sink_pull_sample(), which blocks
 //     until a frame is ready or the pipeline hits EOS/error
 //   - GStreamer's internal appsink queue handles buffering (max-buffers=1)
+//   - With prefetch enabled a background decode thread pulls samples into
+//     an N-deep frame ring instead, so decoding continues while the caller
+//     is busy:
+//       Lossless   – appsink never drops, the decode thread blocks while the
+//                    ring is full (backpressure). For offline files.
+//       LatestWins – the oldest queued frame is overwritten when the ring is
+//                    full, so pull_frame() always gets the freshest frames.
+//                    For live sources.
+//   - In zero-copy mode the RawFrame's cv::Mat points straight into the
+//     mapped GstBuffer and holds a ref on its GstSample; the buffer is
+//     unmapped and the sample released when the last Mat reference drops.
+//     Such frames are read-only — clone() before drawing on them.
+//   - The appsink may negotiate BGR, GRAY8 or I420; RawFrame::format tells
+//     which. I420 is delivered as one packed (h*3/2) x w CV_8UC1 Mat so the
+//     luma plane is a free view for detection/stabilization.
 // ─────────────────────────────────────────────────────────────────────────────
 
 class GstreamerCapture : public IVideoInputStream {
 public:
+    enum class PrefetchMode {
+        Off,           // pull straight from the appsink (default)
+        Lossless,      // decode thread + ring, backpressure when full
+        LatestWins,    // decode thread + ring, drop oldest when full
+    };
+
+    // Counters for the prefetch ring (all zero when prefetch is off).
+    struct Stats {
+        std::uint64_t frames_decoded   = 0;   // pulled from the appsink
+        std::uint64_t frames_delivered = 0;   // handed out by pull_frame()
+        std::uint64_t frames_dropped   = 0;   // overwritten (LatestWins)
+        std::uint64_t decode_stalls    = 0;   // decode waited on a full ring
+        std::uint64_t consumer_stalls  = 0;   // pull_frame() waited on an empty ring
+        std::size_t   queue_size       = 0;   // current occupancy
+        std::size_t   queue_peak       = 0;   // highest occupancy seen
+        double        queue_mean       = 0.0; // mean occupancy seen by pull_frame()
+        std::size_t   queue_capacity   = 0;
+    };
+
     GstreamerCapture() = default;
     ~GstreamerCapture() override { stop(); }
 
@@ -30,9 +69,22 @@ public:
 
     bool start(const std::string& config) override;
     void stop() override;
+    void interrupt() override;
 
     std::optional<RawFrame> pull_frame() override;
 
+    // ── Options (call before start()) ────────────────────────────────────────
+
+    // Wrap the mapped sample instead of deep-copying every frame.
+    void set_zero_copy(bool enable) { zero_copy_ = enable; }
+
+    // Decode on a background thread into a ring of `depth` frames.
+    void set_prefetch(PrefetchMode mode, std::size_t depth = 8);
+
+    // ── Diagnostics ──────────────────────────────────────────────────────────
+
+    Stats stats() const;
+
 private:
     // ── GStreamer objects ────────────────────────────────────────────────────
     GstElement* pipeline_  = nullptr;
@@ -40,8 +92,26 @@ private:
     GstBus*     bus_       = nullptr;
 
     std::atomic<bool> running_{ false };
+    bool              zero_copy_ = false;
+
+    // ── Prefetch ring (guarded by ring_mutex_) ───────────────────────────────
+    PrefetchMode            prefetch_mode_  = PrefetchMode::Off;
+    std::size_t             prefetch_depth_ = 8;
+    std::thread             decode_thread_;
+    mutable std::mutex      ring_mutex_;
+    std::condition_variable ring_not_empty_;
+    std::condition_variable ring_not_full_;
+    std::vector<RawFrame>   ring_;
+    std::size_t             ring_head_   = 0;    // oldest frame
+    std::size_t             ring_count_  = 0;
+    bool                    decode_done_ = true;   // no decode thread running
+    Stats                   stats_;
+    double                  occupancy_sum_ = 0.0;
 
     // ── Helpers ──────────────────────────────────────────────────────────────
+    std::optional<RawFrame> pull_from_appsink();
+    std::optional<RawFrame> pull_from_ring();
+    void     decode_loop();
     RawFrame buffer_to_frame(GstSample* sample) const;
     void     check_bus_messages();
 };
\ No newline at end of file
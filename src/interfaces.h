@@ -6,24 +6,37 @@
 #include <opencv2/dnn.hpp>
 #include <opencv2/video.hpp>
 
+#include "Common/FrameCache.h"
+
 #include <atomic>
 #include <functional>
 #include <memory>
 #include <optional>
 #include <string>
+#include <vector>
 
 // ─────────────────────────────────────────────
 // Types & Aliases
 // ─────────────────────────────────────────────
 
+// Pixel layout of RawFrame::data / StabilizedFrame::data.
+//   BGR  – CV_8UC3, height x width
+//   Gray – CV_8UC1, height x width
+//   I420 – CV_8UC1, (height * 3/2) x width: full-res Y plane followed by the
+//          quarter-res U and V planes, tightly packed
+// Analysis stages read the luma plane directly (see Common/ImageOps.h);
+// only the final crop is converted to BGR.
+enum class PixelFormat { BGR, Gray, I420 };
+
 // Raw frame coming off the GStreamer appsink — owns its data
 struct RawFrame {
     cv::Mat                   data;
+    PixelFormat               format = PixelFormat::BGR;
     std::int64_t              pts_ns = 0;
 
-    std::vector<cv::KeyPoint> keypoints;
-    cv::Mat                   descriptors;
-    bool                      features_computed = false;
+    // Gray image, pyramids, gradients and features, filled lazily by the
+    // first stage that needs them (see Common/FrameCache.h).
+    mutable FrameCache        cache;
 };
 
 // The normalized center point returned by the detector
@@ -31,18 +44,40 @@ struct DetectionResult {
     cv::Point2f           center;          // pixel coords in source space
     float                 confidence = 0.f;
     bool                  valid      = false;
+    bool                  predicted  = false;  // valid, but from the motion model, not a measurement
+};
+
+// One object's result from a multi-reference detector
+struct ObjectDetection {
+    int                   object_id = -1;  // index in the reference list
+    std::string           name;            // reference file stem
+    DetectionResult       result;
+    cv::Rect              bounds;          // projected reference outline (valid only)
 };
 
 // A frame after stabilization, ready to crop
 struct StabilizedFrame {
     cv::Mat               data;
+    PixelFormat           format = PixelFormat::BGR;
     cv::Point2f           suggested_center; // propagated from detection
     std::int64_t          pts_ns = 0;
+
+    // False when the stabilizer buffered the input and has nothing to emit
+    // yet (lookahead smoothing); such frames must be skipped.
+    bool                  ready  = true;
+
+    // Deferred warp (see IVideoStabilizer::set_deferred_warp): `data` is the
+    // unwarped source and `warp` maps source → stabilized coordinates. The
+    // cropper resamples only its output ROI through it.
+    bool                  warp_pending = false;
+    cv::Matx33d           warp         = cv::Matx33d::eye();
+    bool                  warp_affine  = false;     // bottom row is [0 0 1]
+    int                   border_mode  = cv::BORDER_REPLICATE;
 };
 
 // Final deliverable — cropped region at requested output resolution
 struct CroppedFrame {
-    cv::Mat               data;        // cropped frame at output resolution
+    cv::Mat               data;        // cropped BGR frame at output resolution
     cv::Rect              src_roi;     // the ROI used in the stabilized source
     std::int64_t          pts_ns = 0;
 };
@@ -68,6 +103,10 @@ public:
     // Stop and tear down the stream.
     virtual void            stop() = 0;
 
+    // Make a pull_frame() blocked on another thread return nullopt, without
+    // tearing anything down (stop() is still needed afterwards).
+    virtual void            interrupt() {}
+
     // Pull the next frame from the stream. Blocks until one is available
     // or the stream is stopped. Returns nullopt when the stream ends (EOS)
     // or on error.
@@ -137,6 +176,17 @@ public:
     virtual void            warmup() {}
 };
 
+// Detector tracking several reference objects at once. detect() still
+// returns a single result (the primary object) so it drops into the
+// single-object pipeline; detect_all() reports every object.
+class IMultiObjectDetector : public IFeatureDetector {
+public:
+    // One entry per reference, in reference order (object_id == index).
+    virtual std::vector<ObjectDetection> detect_all(RawFrame& frame) = 0;
+
+    virtual std::size_t                  object_count() const = 0;
+};
+
 // ─────────────────────────────────────────────
 // IV. Video Stabilization Interface
 // ─────────────────────────────────────────────
@@ -156,11 +206,22 @@ public:
 
     // Feed a new raw frame. Returns the stabilized version at the same
     // resolution, with the detected center adjusted for any applied transform.
+    // Buffering stabilizers may return an older frame, or one with
+    // ready == false; output order always matches input order.
     virtual StabilizedFrame stabilize(const RawFrame&      frame,
                                       const DetectionResult& detection) = 0;
 
     // Flush any internal buffer (call at EOS).
     virtual void            flush() = 0;
+
+    // After flush(): hand out frames that were still buffered, one per call.
+    // Returns false once nothing is left.
+    virtual bool            drain(StabilizedFrame& /*out*/) { return false; }
+
+    // When enabled, stabilize() skips the full-frame warp and returns the
+    // source with warp_pending set, leaving the resampling to the cropper.
+    // Stabilizers that never warp can ignore this.
+    virtual void            set_deferred_warp(bool /*enable*/) {}
 };
 
 // ─────────────────────────────────────────────
@@ -188,6 +249,7 @@ public:
 
     // Perform the actual crop and return the final frame.
     // The output dimensions are specified by out_w and out_h.
+    // Frames with warp_pending must be resampled through their warp.
     virtual CroppedFrame    crop(const StabilizedFrame& frame,
                                  int out_w,
                                  int out_h) = 0;
@@ -6,15 +6,23 @@
 #include "Stabilization/StubStabilizer.h"
 #include "Cropping/StubCropper.h"
 #include "Stabilization/OFStabilizer.h"
+#include "Stabilization/PhaseCorrStabilizer.h"
+#include "Stabilization/TelemetryStabilizer.h"
 #include "FeatureDetection/ORBDetector.h"
+#include "FeatureDetection/MultiRefDetector.h"
+#include "FeatureDetection/OnnxDetector.h"
+#include "FeatureDetection/TrackingDetector.h"
 #include "VideoOutputStream/OpenCVWindowOutput.h"
 #include "VideoOutputStream/GstreamerFileOutput.h"
 #include "Stabilization/EdRansacStabilizer.h"
+#include "Pipeline/ThreadedPipeline.h"
+#include "Telemetry/Profiler.h"
 
 #include <gst/gst.h>
 #include <opencv2/highgui.hpp>
 
 #include <csignal>
+#include <cstdlib>
 #include <iostream>
 #include <memory>
 #include <string>
@@ -34,17 +42,25 @@ struct ResolutionConfig {
 // Graceful shutdown on Ctrl-C
 // ─────────────────────────────────────────────────────────────────────────────
 
-static std::atomic<bool> g_shutdown{ false };
+static IPipelineOrchestrator* g_pipeline = nullptr;
 
 static void signal_handler(int /*sig*/)
 {
-    g_shutdown.store(true);
+    // stop() only stores an atomic flag, so it is safe to call from here.
+    if (g_pipeline) {
+        g_pipeline->stop();
+    }
 }
 
 // ─────────────────────────────────────────────────────────────────────────────
 // Build the GStreamer launch string
 //
-// Source: file  →  decode  →  framerate  →  scale to target resolution  →  BGR  →  appsink
+// Source: file  →  decode  →  framerate  →  scale to target resolution  →  I420  →  appsink
+//
+// I420 is what the decoders produce natively, so videoconvert is usually a
+// passthrough. Detection/stabilization read the Y plane directly and only
+// the cropped output is converted to BGR. Use format=BGR or GRAY8 to
+// compare against the old colour path.
 //
 // If you want to later swap in a live camera, replace the first two elements:
 //   v4l2src device=/dev/video0 ! video/x-raw,width=<src_w>,height=<src_h>
@@ -68,7 +84,7 @@ static std::string build_pipeline(const std::string& video_path,
         "video/x-raw,width=" + std::to_string(src_width) + ","
             "height=" + std::to_string(src_height) + " ! "
         "videoconvert ! "
-        "video/x-raw,format=BGR ! "
+        "video/x-raw,format=I420 ! "
         "appsink name=sink sync=false";
 }
 
@@ -80,13 +96,19 @@ static std::string build_pipeline(const std::string& video_path,
 //
 // Arguments:
 //   input_video      - Path to input video file (required)
-//   reference_image  - Path to reference object image (required)
+//   reference_image  - Path to reference object image (required). A
+//                      ';'-separated list or a folder of images tracks
+//                      several objects (MultiRefDetector); the crop follows
+//                      the most confident one. A .onnx file runs that
+//                      model instead (OnnxDetector, YOLO-style output)
 //   output_file      - Optional: Path to output video file (e.g., output.mp4)
 //                      If not specified, displays output in a window
 //
 // Examples:
 //   ./video_pipeline input.mp4 reference.jpg
 //   ./video_pipeline input.mp4 reference.jpg output.mp4
+//   ./video_pipeline input.mp4 "runway.jpg;hangar.jpg" output.mp4
+//   ./video_pipeline input.mp4 yolov8n.onnx output.mp4
 // ─────────────────────────────────────────────────────────────────────────────
 
 int main(int argc, char* argv[])
@@ -113,6 +135,12 @@ int main(int argc, char* argv[])
                                           : "/home/tobia/reference_object.jpg";
     const std::string output_file     = (argc > 3) ? argv[3] : "";  // Optional output file
 
+    // PIPELINE_TRACE=trace.json → per-stage Chrome trace (open in Perfetto)
+    if (const char* trace_path = std::getenv("PIPELINE_TRACE")) {
+        Profiler::instance().enable_trace(trace_path);
+        std::cout << "Trace file    : " << trace_path << "\n";
+    }
+
     std::cout << "Video source  : " << video_path      << "\n"
               << "Reference img : " << reference_image  << "\n";
     if (!output_file.empty()) {
@@ -120,11 +148,58 @@ int main(int argc, char* argv[])
     }
 
     // ── Instantiate pipeline stages ──────────────────────────────────────────
-    auto input    = std::make_unique<GstreamerCapture>();
-    auto detector   = std::make_unique<ORBDetector>();
-    auto stabilizer = std::make_unique<OFStabilizer>();
+    auto input      = std::make_unique<GstreamerCapture>();
     auto cropper    = std::make_unique<StubCropper>();
-    
+
+    // PIPELINE_STABILIZER=phasecorr → keypoint-free phase-correlation
+    // stabilizer, =telemetry → attitude sidecar (PIPELINE_TELEMETRY); the
+    // optical-flow stabilizer otherwise.
+    std::unique_ptr<IVideoStabilizer> stabilizer;
+    OFStabilizer* stabilizer_ptr = nullptr;
+    const char* stabilizer_env  = std::getenv("PIPELINE_STABILIZER");
+    const std::string stabilizer_name = stabilizer_env ? stabilizer_env : "";
+    if (stabilizer_name == "phasecorr") {
+        stabilizer = std::make_unique<PhaseCorrStabilizer>();
+    } else if (stabilizer_name == "telemetry") {
+        stabilizer = std::make_unique<TelemetryStabilizer>();
+    } else {
+        auto of = std::make_unique<OFStabilizer>();
+        stabilizer_ptr = of.get();
+        stabilizer     = std::move(of);
+    }
+
+    // Frames are only read downstream (the overlay is drawn on the cropped
+    // output), so the capture can hand out views of the GStreamer buffers.
+    input->set_zero_copy(true);
+
+    // File input: decode ahead on a background thread and never drop frames.
+    // Use PrefetchMode::LatestWins for live cameras.
+    input->set_prefetch(GstreamerCapture::PrefetchMode::Lossless, 8);
+
+    // Kept for wiring after init — ownership moves into the pipeline.
+    std::unique_ptr<IFeatureDetector> detector;
+    ORBDetector*      orb_detector_ptr   = nullptr;
+    MultiRefDetector* multi_detector_ptr = nullptr;
+    const bool use_onnx = reference_image.size() > 5 &&
+                          reference_image.compare(reference_image.size() - 5, 5, ".onnx") == 0;
+    if (use_onnx) {
+        detector = std::make_unique<OnnxDetector>();
+    } else if (MultiRefDetector::is_reference_set(reference_image)) {
+        auto multi = std::make_unique<MultiRefDetector>();
+        multi_detector_ptr = multi.get();
+        detector           = std::move(multi);
+    } else {
+        auto orb = std::make_unique<ORBDetector>();
+        orb_detector_ptr = orb.get();
+        detector         = std::move(orb);
+    }
+
+    // Full detection every 5th frame (or when tracking weakens), LK
+    // tracking in between, so every frame still gets a valid centre.
+    auto tracker = std::make_unique<TrackingDetector>(std::move(detector));
+    tracker->detect_every_n = 5;
+    detector = std::move(tracker);
+
     // Create appropriate output stream based on whether output file is specified
     std::unique_ptr<IVideoOutputStream> output;
     if (!output_file.empty()) {
@@ -133,18 +208,6 @@ int main(int argc, char* argv[])
         output = std::make_unique<OpenCVWindowOutput>();
     }
 
-    // ── Init detection & stabilization ──────────────────────────────────────
-    if (!detector->init("", "", reference_image)) {
-        std::cerr << "Detector init failed.\n";
-        return 1;
-    }
-    if (!stabilizer->init("", "")) {
-        std::cerr << "Stabilizer init failed.\n";
-        return 1;
-    }
-
-    stabilizer->set_orb_model(detector->ModelORB);
-
     // ── Init output stream ───────────────────────────────────────────────────
     std::string output_config;
     if (!output_file.empty()) {
@@ -165,57 +228,63 @@ int main(int argc, char* argv[])
         return 1;
     }
 
-    // ── Start input stream ───────────────────────────────────────────────────
-    const std::string pipeline_str = build_pipeline(video_path,
-                                                     res_config.src_width,
-                                                     res_config.src_height);
-    std::cout << "Pipeline: " << pipeline_str << "\n\n";
-    if (!input->start(pipeline_str)) {
-        std::cerr << "Failed to start input stream.\n";
-        return 1;
-    }
+    // ── Build the staged pipeline ────────────────────────────────────────────
+    // Each stage runs on its own thread; queue depths bound the number of
+    // in-flight 4K frames (and therefore memory) between stages.
+    ThreadedPipeline::Options opts;
+    opts.capture_queue_depth   = 4;
+    opts.detect_queue_depth    = 4;
+    opts.stabilize_queue_depth = 4;
+    opts.output_queue_depth    = 4;
+    opts.output_width          = res_config.output_width;
+    opts.output_height         = res_config.output_height;
+    opts.detect_every_n        = 1;     // TrackingDetector schedules the expensive detections
+    opts.draw_detection        = true;  // Overlay detected centre
 
-    // ── Frame loop ───────────────────────────────────────────────────────────
-    std::size_t frame_count = 0;
-    constexpr int PROCESS_EVERY_N_FRAMES = 1;  // Process every frame (change to 2 for 50% speed improvement)
+    ThreadedPipeline pipeline(std::move(input),
+                              std::move(detector),
+                              std::move(stabilizer),
+                              std::move(cropper),
+                              opts);
 
-    while (!g_shutdown.load() && output->is_open()) {
+    IPipelineOrchestrator::Config cfg;
+    cfg.gst_pipeline_desc  = build_pipeline(video_path,
+                                            res_config.src_width,
+                                            res_config.src_height);
+    if (use_onnx) {
+        cfg.detector_weights   = reference_image;
+    } else {
+        cfg.detector_reference = reference_image;
+    }
 
-        // 1. Pull raw frame from the input stream (blocks until available or EOS).
-        auto maybe_frame = input->pull_frame();
-        if (!maybe_frame.has_value()) {
-            std::cout << "Stream ended (EOS or error).\n";
-            break;
-        }
-        RawFrame& raw = *maybe_frame;
-
-        // 2. Object detection → get center point only (skip on some frames for speed).
-        DetectionResult detection;
-        if (frame_count % PROCESS_EVERY_N_FRAMES == 0) {
-            detection = detector->detect(raw);
-        } else {
-            detection.valid = false;
-        }
-        
-        if (detection.valid) {
-            // Overlay detected centre
-            cv::circle(raw.data,
-                       static_cast<cv::Point>(detection.center),
-                       12, { 0, 255, 0 }, 2);
+    // PIPELINE_DETECTOR_CONFIG="coarse_scale=0.25,refine_margin=2" → detector
+    // options (see each detector's init(); unknown keys are reported)
+    if (const char* detector_config = std::getenv("PIPELINE_DETECTOR_CONFIG")) {
+        cfg.detector_config = detector_config;
+        std::cout << "Detector cfg  : " << cfg.detector_config << "\n";
+    }
+    if (const char* stabilizer_config = std::getenv("PIPELINE_STABILIZER_CONFIG")) {
+        cfg.stabilizer_config = stabilizer_config;
+        std::cout << "Stabilizer cfg: " << cfg.stabilizer_config << "\n";
+    }
+    if (stabilizer_name == "telemetry") {
+        const char* telemetry_path = std::getenv("PIPELINE_TELEMETRY");
+        if (!telemetry_path) {
+            std::cerr << "PIPELINE_STABILIZER=telemetry needs PIPELINE_TELEMETRY=<sidecar>.\n";
+            return 1;
         }
+        cfg.stabilizer_weights = telemetry_path;
+        std::cout << "Telemetry     : " << cfg.stabilizer_weights << "\n";
+    }
+    std::cout << "Pipeline: " << cfg.gst_pipeline_desc << "\n\n";
 
-        // 3. Video stabilization (operates at source resolution).
-        StabilizedFrame stabilized = stabilizer->stabilize(raw, detection);
-
-        // 4. Crop to output resolution centred on the detected object.
-        CroppedFrame cropped = cropper->crop(stabilized,
-                                             res_config.output_width,
-                                             res_config.output_height);
-
-        // 5. Write to output stream (display window).
-        if (!output->write_frame(cropped)) {
+    // ── Output callback (runs on this thread) ────────────────────────────────
+    std::size_t frame_count = 0;
+    auto on_frame = [&](const CroppedFrame& cropped) {
+        if (!output->is_open() || !output->write_frame(cropped)) {
             std::cout << "Output stream closed.\n";
-            g_shutdown.store(true);
+            pipeline.stop();
+            return;
         }
 
         ++frame_count;
@@ -223,14 +292,35 @@ int main(int argc, char* argv[])
             std::cout << "Processed " << frame_count << " frames  |  "
                       << "ROI: " << cropped.src_roi << "\n";
         }
+    };
+
+    // ── Init detection, stabilization & input stream ────────────────────────
+    if (!pipeline.init(cfg, on_frame)) {
+        std::cerr << "Pipeline init failed.\n";
+        return 1;
     }
 
+    // Share the detector's ORB model (the stabilizer creates its own otherwise)
+    if (!stabilizer_ptr) {
+        // Phase correlation and telemetry use no keypoints
+    } else if (multi_detector_ptr) {
+        stabilizer_ptr->set_orb_model(multi_detector_ptr->orb_model());
+    } else if (orb_detector_ptr) {
+        stabilizer_ptr->set_orb_model(orb_detector_ptr->ModelORB);
+    }
+
+    // ── Frame loop ───────────────────────────────────────────────────────────
+    g_pipeline = &pipeline;
+    pipeline.run();
+    g_pipeline = nullptr;
+
     // ── Cleanup ──────────────────────────────────────────────────────────────
-    stabilizer->flush();
-    input->stop();
     output->close();
     cv::destroyAllWindows();
 
+    Profiler::instance().report(std::cout);
+    Profiler::instance().write_trace();
+
     std::cout << "Done. Total frames processed: " << frame_count << "\n";
     return 0;
 }
\ No newline at end of file